@@ -28,50 +28,357 @@
 
 #define BAUD_RATE 19200 //UART BAUD RATE
 
+//TAMANHOS USADOS NA COMPARACAO ENTRE AS IMPLEMENTACOES EM SOFTWARE.
+static const int tamanhosBenchmark[] = {MAX_MATRIX, 64, 96};
+
+typedef struct {
+  const char * nome;
+  FuncaoMultiplicacao funcao;
+} ImplementacaoSoftware;
+
+static const ImplementacaoSoftware implementacoes[] = {
+  {"INGENUA", multiplicarMatriz},
+  {"BLOCADA", multiplicarMatrizBlocada},
+};
+
+//DIFERENCA MAXIMA ACEITA ENTRE UMA IMPLEMENTACAO E A REFERENCIA EM PONTO FIXO: UM PASSO Q8.8. AS IMPLEMENTACOES
+//SOMAM OS MESMOS PRODUTOS Q8.8 E DEVEM COINCIDIR; A FOLGA SO ACEITA UMA OUTRA ORDEM DE ARREDONDAMENTO.
+#define TOLERANCIA_SOFTWARE (1.0f / 256)
+
+//CONTA OS ELEMENTOS DE matrizC QUE DIFEREM DE referencia EM MAIS DE TOLERANCIA_SOFTWARE (TODOS, SE NAO HOUVER matrizC).
+static uint32_t contaDivergencias(const MatrizFloat * matrizC, const MatrizFloat * referencia){
+  if(matrizC == NULL)
+    return (uint32_t)(referencia->linhas * referencia->colunas);
+
+  uint32_t divergencias = 0;
+  int i, j;
+  for(i = 0; i < referencia->linhas; i++){
+    for(j = 0; j < referencia->colunas; j++){
+      float diferenca = elementoMatriz(matrizC, i, j) - elementoMatriz(referencia, i, j);
+      if(diferenca > TOLERANCIA_SOFTWARE || diferenca < -TOLERANCIA_SOFTWARE) divergencias++;
+    }
+  }
+  return divergencias;
+}
+
+//ENTRADA DO BENCHMARK EM SOFTWARE: OS VALORES DE instanciaMatrizAleatoriamente (QUE PASSAM DE 255) SAO REESCALADOS PARA
+//[0, limite], COM tamK * limite^2 < 2^16, PARA QUE NEM OS OPERANDOS Q8.8 NEM AS SOMAS Q16.16 DE tamK PRODUTOS ESTOUREM.
+static void instanciaEntradaBenchmark(MatrizFloat * matriz, int tamK){
+  int limite = 1;
+  while(limite < 255 && (limite + 1) * (limite + 1) * tamK < 65536) limite++;
+
+  instanciaMatrizAleatoriamente(matriz);
+  float maximo = 0;
+  int i, j;
+  for(i = 0; i < matriz->linhas; i++){
+    for(j = 0; j < matriz->colunas; j++){
+      if(elementoMatriz(matriz, i, j) > maximo) maximo = elementoMatriz(matriz, i, j);
+    }
+  }
+
+  float escala = (maximo > 0) ? limite / maximo : 1;
+  for(i = 0; i < matriz->linhas; i++){
+    for(j = 0; j < matriz->colunas; j++)
+      elementoMatriz(matriz, i, j) *= escala;
+  }
+  marcarMatrizAlterada(matriz);
+}
+
+//MEDE CADA IMPLEMENTACAO EM SOFTWARE PARA CADA TAMANHO DE tamanhosBenchmark E CONFERE O SEU RESULTADO COM O DE
+//multiplicarMatrizPontoFixo. AS COPIAS Q8.8 SAO FEITAS ANTES DAS MEDIDAS, PARA QUE NENHUMA IMPLEMENTACAO PAGUE A CONVERSAO.
+static void comparaImplementacoesSoftware(void){
+  unsigned int t, f;
+  for(t = 0; t < sizeof(tamanhosBenchmark)/sizeof(tamanhosBenchmark[0]); t++){
+    int tam = tamanhosBenchmark[t];
+    MatrizFloat * matrizA = criarMatrizFloat(tam, tam);
+    MatrizFloat * matrizB = criarMatrizFloat(tam, tam);
+    instanciaEntradaBenchmark(matrizA, tam);
+    instanciaEntradaBenchmark(matrizB, tam);
+    const Matriz16Bits * matrizA16 = obterMatrizQuantizada(matrizA);
+    const Matriz16Bits * matrizB16 = obterMatrizQuantizada(matrizB);
+
+    uint64_t inicio = neorv32_mtime_get_time();
+    MatrizFloat * referencia = multiplicarMatrizPontoFixo(matrizA16, matrizB16);
+    uint64_t tempo = neorv32_mtime_get_time() - inicio;
+
+    myPrint("PONTO FIXO %dx%d", tam, tam);
+    longPrint(" TEMPO: ", ((double)tempo)/50000000);
+    myPrint("\n");
+
+    for(f = 0; f < sizeof(implementacoes)/sizeof(implementacoes[0]); f++){
+      inicio = neorv32_mtime_get_time();
+      MatrizFloat * matrizC = implementacoes[f].funcao(matrizA, matrizB);
+      tempo = neorv32_mtime_get_time() - inicio;
+
+      myPrint("%s %dx%d", implementacoes[f].nome, tam, tam);
+      longPrint(" TEMPO: ", ((double)tempo)/50000000);
+      myPrint(" (%u divergencias)\n", contaDivergencias(matrizC, referencia));
+      destruirMatrizFloat(matrizC);
+    }
+
+    destruirMatrizFloat(referencia);
+    destruirMatrizFloat(matrizA);
+    destruirMatrizFloat(matrizB);
+  }
+}
+
+
+//MEDE, EM CICLOS, AS CONVERSOES ITERATIVAS E AS BASEADAS NOS BITS IEEE-754, CONFERINDO SE SAO IDENTICAS
+//PARA TODOS OS VALORES Q8.8 (E OS PONTOS MEDIOS ENTRE ELES).
+static void comparaConversoes(void){
+  volatile uint32_t acumulador = 0;
+  uint32_t divergencias = 0;
+  uint32_t n;
+  uint64_t inicio, ciclosIterativo, ciclosBits;
+
+  for(n = 0; n < 65536; n++){
+    float valor = (float)n / 256 + (1.0f / 1024);
+    if(converteParaPontoFixo(valor) != converteParaPontoFixoIterativo(valor)) divergencias++;
+    if(converteParaFloat(n << 8) != converteParaFloatIterativo(n << 8)) divergencias++;
+  }
+
+  inicio = neorv32_cpu_get_cycle();
+  for(n = 0; n < 65536; n++) acumulador += converteParaPontoFixoIterativo((float)n / 256);
+  ciclosIterativo = neorv32_cpu_get_cycle() - inicio;
+  inicio = neorv32_cpu_get_cycle();
+  for(n = 0; n < 65536; n++) acumulador += converteParaPontoFixo((float)n / 256);
+  ciclosBits = neorv32_cpu_get_cycle() - inicio;
+  myPrint("float -> Q8.8: %u ciclos/conversao (iterativa), %u ciclos/conversao (bits)\n",
+          (uint32_t)(ciclosIterativo / 65536), (uint32_t)(ciclosBits / 65536));
+
+  inicio = neorv32_cpu_get_cycle();
+  for(n = 0; n < 65536; n++) acumulador += (uint32_t)converteParaFloatIterativo(n << 8);
+  ciclosIterativo = neorv32_cpu_get_cycle() - inicio;
+  inicio = neorv32_cpu_get_cycle();
+  for(n = 0; n < 65536; n++) acumulador += (uint32_t)converteParaFloat(n << 8);
+  ciclosBits = neorv32_cpu_get_cycle() - inicio;
+  myPrint("Q16.16 -> float: %u ciclos/conversao (iterativa), %u ciclos/conversao (bits)\n",
+          (uint32_t)(ciclosIterativo / 65536), (uint32_t)(ciclosBits / 65536));
+
+  myPrint("Divergencias entre as conversoes: %u\n\n", divergencias);
+}
+
+//CONFERE O CFS CONTRA A REFERENCIA EM SOFTWARE PARA UM PRODUTO (m x tamK) x (tamK x n) QUALQUER
+//E IMPRIME O PERFIL DOS CONTADORES DE DESEMPENHO DO CFS DURANTE A MULTIPLICACAO.
+static void verificaHardware(int m, int tamK, int n){
+  MatrizFloat * matrizA = criarMatrizFloat(m, tamK);
+  MatrizFloat * matrizB = criarMatrizFloat(tamK, n);
+  MatrizFloat * matrizC = criarMatrizFloat(m, n);
+  instanciaMatrizAleatoriamente(matrizA);
+  instanciaMatrizAleatoriamente(matrizB);
+
+  ContadoresCFS contadores;
+  zerarContadoresCFS();
+  zerarEscritasCFS();
+  uint64_t inicio = neorv32_mtime_get_time();
+  int erro = multiplica_hardware(matrizA, matrizB, matrizC);
+  uint64_t tempo = neorv32_mtime_get_time() - inicio;
+  uint32_t escritas = obterEscritasCFS();
+  lerContadoresCFS(&contadores);
+
+  MatrizFloat * referencia = multiplicarMatrizPontoFixo(obterMatrizQuantizada(matrizA), obterMatrizQuantizada(matrizB));
+  uint32_t divergencias = 0;
+  int i, j;
+  for(i = 0; i < m; i++){
+    for(j = 0; j < n; j++){
+      if(elementoMatriz(matrizC, i, j) != elementoMatriz(referencia, i, j)) divergencias++;
+    }
+  }
+
+  if(erro)
+    myPrint("HARDWARE %dx%dx%d: CFS recusou o produto (operandos menores que Q8.8)\n", m, tamK, n);
+  else {
+    myPrint("HARDWARE %dx%dx%d: %u divergencias, %u escritas no CFS por elemento", m, tamK, n, divergencias,
+            escritas / (uint32_t)(m * n));
+    longPrint(" TEMPO: ", ((double)tempo)/50000000);
+    myPrint("\n");
+    imprimirPerfilCFS(&contadores);
+  }
+
+  destruirMatrizFloat(referencia);
+  destruirMatrizFloat(matrizA);
+  destruirMatrizFloat(matrizB);
+  destruirMatrizFloat(matrizC);
+}
+
+//CONFERE O MODO INT8 DO CFS CONTRA A REFERENCIA EM SOFTWARE, COM AS MATRIZES QUANTIZADAS POR quantizaMatrizInt8.
+static void verificaHardwareInt8(int m, int tamK, int n){
+  MatrizFloat * matrizA = criarMatrizFloat(m, tamK);
+  MatrizFloat * matrizB = criarMatrizFloat(tamK, n);
+  MatrizFloat * matrizC = criarMatrizFloat(m, n);
+  Matriz8Bits * matrizA8 = criarMatriz8Bits(m, tamK);
+  Matriz8Bits * matrizB8 = criarMatriz8Bits(tamK, n);
+  instanciaMatrizAleatoriamente(matrizA);
+  instanciaMatrizAleatoriamente(matrizB);
+  quantizaMatrizInt8(matrizA, matrizA8);
+  quantizaMatrizInt8(matrizB, matrizB8);
+
+  zerarEscritasCFS();
+  uint64_t inicio = neorv32_mtime_get_time();
+  int erro = multiplicaHardwareInt8(matrizA8, matrizB8, matrizC);
+  uint64_t tempo = neorv32_mtime_get_time() - inicio;
+  uint32_t escritas = obterEscritasCFS();
+
+  MatrizFloat * referencia = multiplicarMatrizInt8(matrizA8, matrizB8);
+  uint32_t divergencias = 0;
+  int i, j;
+  for(i = 0; i < m; i++){
+    for(j = 0; j < n; j++){
+      if(elementoMatriz(matrizC, i, j) != elementoMatriz(referencia, i, j)) divergencias++;
+    }
+  }
+
+  if(erro)
+    myPrint("HARDWARE INT8 %dx%dx%d: CFS sem modo int8\n", m, tamK, n);
+  else {
+    myPrint("HARDWARE INT8 %dx%dx%d: %u divergencias, %u escritas no CFS por elemento", m, tamK, n, divergencias,
+            escritas / (uint32_t)(m * n));
+    longPrint(" TEMPO: ", ((double)tempo)/50000000);
+    myPrint("\n");
+  }
+
+  destruirMatrizFloat(referencia);
+  destruirMatriz8Bits(matrizA8);
+  destruirMatriz8Bits(matrizB8);
+  destruirMatrizFloat(matrizA);
+  destruirMatrizFloat(matrizB);
+  destruirMatrizFloat(matrizC);
+}
+
+//COMPARA O PRODUTO EM PONTO FIXO PELAS INSTRUCOES DA CFU COM O DO CFS E O DO SOFTWARE (TEMPOS E DIVERGENCIAS).
+//CADA CAMINHO ESCREVE EM SUA PROPRIA MATRIZ C, CONFERIDA CONTRA A REFERENCIA SO SE O CAMINHO TERMINOU SEM ERRO.
+static void verificaCFU(int m, int tamK, int n){
+  MatrizFloat * matrizA = criarMatrizFloat(m, tamK);
+  MatrizFloat * matrizB = criarMatrizFloat(tamK, n);
+  MatrizFloat * matrizCFS = criarMatrizFloat(m, n);
+  MatrizFloat * matrizCFU = criarMatrizFloat(m, n);
+  instanciaMatrizAleatoriamente(matrizA);
+  instanciaMatrizAleatoriamente(matrizB);
+  const Matriz16Bits * a = obterMatrizQuantizada(matrizA);
+  const Matriz16Bits * b = obterMatrizQuantizada(matrizB);
+
+  uint64_t inicio = neorv32_mtime_get_time();
+  MatrizFloat * referencia = multiplicarMatrizPontoFixo(a, b);
+  uint64_t tempoSoftware = neorv32_mtime_get_time() - inicio;
+
+  inicio = neorv32_mtime_get_time();
+  int erroCFS = multiplicaHardwarePontoFixo(a, b, matrizCFS);
+  uint64_t tempoCFS = neorv32_mtime_get_time() - inicio;
+
+  inicio = neorv32_mtime_get_time();
+  int erro = multiplicaCFU(a, b, matrizCFU);
+  uint64_t tempoCFU = neorv32_mtime_get_time() - inicio;
+
+  uint32_t divergencias = 0, divergenciasCFS = 0;
+  int i, j;
+  for(i = 0; i < m; i++){
+    for(j = 0; j < n; j++){
+      if(elementoMatriz(matrizCFU, i, j) != elementoMatriz(referencia, i, j)) divergencias++;
+      if(elementoMatriz(matrizCFS, i, j) != elementoMatriz(referencia, i, j)) divergenciasCFS++;
+    }
+  }
+
+  if(erro)
+    myPrint("CFU %dx%dx%d: CPU sem CFU\n", m, tamK, n);
+  else {
+    myPrint("CFU %dx%dx%d: %u divergencias", m, tamK, n, divergencias);
+    longPrint(" TEMPO CFU: ", ((double)tempoCFU)/50000000);
+    longPrint(" CFS: ", ((double)tempoCFS)/50000000);
+    longPrint(" SOFTWARE: ", ((double)tempoSoftware)/50000000);
+    myPrint("\n");
+  }
+  if(erroCFS)
+    myPrint("CFS %dx%dx%d: CFS recusou o produto\n", m, tamK, n);
+  else
+    myPrint("CFS %dx%dx%d: %u divergencias\n", m, tamK, n, divergenciasCFS);
+
+  destruirMatrizFloat(referencia);
+  destruirMatrizFloat(matrizA);
+  destruirMatrizFloat(matrizB);
+  destruirMatrizFloat(matrizCFS);
+  destruirMatrizFloat(matrizCFU);
+}
+
+//CONFERE O PRODUTO ESCALAR ACUMULADO NO CFS PARA UM VETOR LONGO (LINHA DE A POR COLUNA DE B).
+static void verificaProdutoEscalar(int tamanho){
+  MatrizFloat * matrizA = criarMatrizFloat(1, tamanho);
+  MatrizFloat * matrizB = criarMatrizFloat(tamanho, 1);
+  instanciaMatrizAleatoriamente(matrizA);
+  instanciaMatrizAleatoriamente(matrizB);
+  const Matriz16Bits * a = obterMatrizQuantizada(matrizA);
+  const Matriz16Bits * b = obterMatrizQuantizada(matrizB);
+
+  zerarEscritasCFS();
+  uint32_t resultado = produtoEscalarHardware(a->dados, 1, b->dados, b->passo, tamanho);
+  uint32_t escritas = obterEscritasCFS();
+
+  MatrizFloat * referencia = multiplicarMatrizPontoFixo(a, b);
+  myPrint("PRODUTO ESCALAR DE %d ELEMENTOS: %s, %u escritas no CFS, estouro = %u\n", tamanho,
+          (converteParaFloat(resultado) == elementoMatriz(referencia, 0, 0)) ? "confere" : "DIVERGE", escritas,
+          (NEORV32_CFS->REG[CFS_REG_STATUS] & CFS_STATUS_ESTOURO) != 0);
+
+  destruirMatrizFloat(referencia);
+  destruirMatrizFloat(matrizA);
+  destruirMatrizFloat(matrizB);
+}
 
 int main() {
-  float ** matrizA = criarMatrizFloat(MAX_MATRIX);
-  instanciaMatrizIdentidade(matrizA, MAX_MATRIX);
+  comparaConversoes();
 
-  float ** matrizB = criarMatrizFloat(MAX_MATRIX);
-  instanciaMatrizUnitaria(matrizB, MAX_MATRIX);
+  MatrizFloat * matrizA = criarMatrizFloat(MAX_MATRIX, MAX_MATRIX);
+  instanciaMatrizIdentidade(matrizA);
+
+  MatrizFloat * matrizB = criarMatrizFloat(MAX_MATRIX, MAX_MATRIX);
+  instanciaMatrizUnitaria(matrizB);
 
   uint64_t inicio = neorv32_mtime_get_time();
 
-  float ** matrizC = multiplicarMatriz(matrizA, matrizB, MAX_MATRIX);
+  MatrizFloat * matrizC = multiplicarMatriz(matrizA, matrizB);
 
   uint64_t tempo  = neorv32_mtime_get_time() - inicio;
 
   longPrint("TEMPO SOFTWARE: ", ((double)tempo)/50000000);
   myPrint("\n");
   
-  destruirMatrizFloat(matrizA, MAX_MATRIX);
-  destruirMatrizFloat(matrizB, MAX_MATRIX);
-  destruirMatrizFloat(matrizC, MAX_MATRIX);
+  destruirMatrizFloat(matrizA);
+  destruirMatrizFloat(matrizB);
+  destruirMatrizFloat(matrizC);
+
+  comparaImplementacoesSoftware();
 
 //------------------------------------------------------------
 
-  float **mat1, **mat2, **mat3;
+  MatrizFloat *mat1, *mat2, *mat3;
   
-  mat1 = criarMatrizFloat(MAX_MATRIX);
-  mat2 = criarMatrizFloat(MAX_MATRIX);
-  mat3 = criarMatrizFloat(MAX_MATRIX);
+  mat1 = criarMatrizFloat(MAX_MATRIX, MAX_MATRIX);
+  mat2 = criarMatrizFloat(MAX_MATRIX, MAX_MATRIX);
+  mat3 = criarMatrizFloat(MAX_MATRIX, MAX_MATRIX);
 
-  instanciaMatrizIdentidade(mat1, MAX_MATRIX);
-  instanciaMatrizUnitaria(mat2, MAX_MATRIX);
+  instanciaMatrizIdentidade(mat1);
+  instanciaMatrizUnitaria(mat2);
   
   inicio = neorv32_mtime_get_time();
-  multiplica_hardware(mat1, mat2, mat3);
+  if(multiplica_hardware(mat1, mat2, mat3) != 0) { //CFS SEM OPERANDOS Q8.8 COMPLETOS: PRODUTO EM SOFTWARE.
+    destruirMatrizFloat(mat3);
+    mat3 = multiplicarMatriz(mat1, mat2);
+  }
   tempo = neorv32_mtime_get_time() - inicio;
 
-  imprimirMatrizFloat(mat3, MAX_MATRIX);
+  imprimirMatrizFloat(mat3);
 
   longPrint("TEMPO HARDWARE: ", ((double)tempo)/50000000);
   myPrint("\n");
   
-  destruirMatrizFloat(mat1, MAX_MATRIX);
-  destruirMatrizFloat(mat2, MAX_MATRIX);
-  destruirMatrizFloat(mat3, MAX_MATRIX);
+  destruirMatrizFloat(mat1);
+  destruirMatrizFloat(mat2);
+  destruirMatrizFloat(mat3);
+
+  verificaHardware(MAX_MATRIX, MAX_MATRIX, MAX_MATRIX);
+  verificaHardware(100, 130, 70);
+  verificaHardwareInt8(100, 130, 70);
+  verificaCFU(MAX_MATRIX, MAX_MATRIX, MAX_MATRIX);
+  verificaCFU(100, 131, 70);
+  verificaProdutoEscalar(1000);
 
   myPrint("\n");
   myPrint("Fim do programa! :)");
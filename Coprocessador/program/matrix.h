@@ -28,20 +28,184 @@
 #include <neorv32.h>
 
 #define MAX_MATRIX 40
-#define NUM_REG_CFS 63
+#define NUM_REG_CFS 63 //MAXIMO DE VIAS DO CFS; AS SINTETIZADAS ESTAO EM CFS_REG_INFO.
+#define CFS_REG_RESULTADO 63 //LEITURA: SOMA DOS PRODUTOS DE TODAS AS VIAS.
+#define CFS_REG_CONTROLE 63  //ESCRITA: REGISTRADOR DE CONTROLE DO CFS.
+#define CFS_REG_STATUS 0     //LEITURA: ESTADO DO CFS.
+#define CFS_STATUS_VALIDO (1 << 0) //ESTADO: A SOMA JA REFLETE A ULTIMA ESCRITA NAS VIAS.
+#define CFS_STATUS_ESTOURO (1 << 1) //ESTADO: O ACUMULADOR SATUROU NO SEU MAXIMO.
+#define CFS_STATUS_IRQ (1 << 2)     //ESTADO: INTERRUPCAO PENDENTE.
+#define CFS_STATUS_BANCO (1 << 3)   //ESTADO: BANCO A ATIVO (0 OU 1).
+#define CFS_COLUNAS 4              //COLUNAS DE SAIDA DO CFS QUANDO CFS_REG_INFO NAO AS INFORMA.
+#define CFS_REG_SOMA_COLUNA(p) (8 + (p))            //LEITURA: SOMA DAS VIAS DA COLUNA p.
+#define CFS_REG_ACUMULADOR_LO(p) (16 + 2 * (p))     //LEITURA: BITS 31..0 DO ACUMULADOR DA COLUNA p.
+#define CFS_REG_ACUMULADOR_HI(p) (17 + 2 * (p))     //LEITURA: BITS ALTOS DO ACUMULADOR DA COLUNA p A PARTIR DO BIT 0 E O ESTOURO NO BIT 31.
+#define CFS_SEL_PAR 0        //CONTROLE: A PALAVRA n LEVA (a << 16) | b DA VIA n.
+#define CFS_SEL_BANCO_A 1    //CONTROLE: A PALAVRA n LEVA AS VIAS 2n (BITS 15..0) E 2n+1 (BITS 31..16) DE A.
+#define CFS_SEL_BANCO_B 2    //CONTROLE: A PALAVRA n LEVA AS VIAS 2n (BITS 15..0) E 2n+1 (BITS 31..16) DE B.
+#define CFS_SEL_CONFIG 3     //CONTROLE: A PALAVRA n ESCREVE O REGISTRADOR DE CONFIGURACAO n.
+#define CFS_CONFIG_LIMIAR_IRQ 0 //CONFIGURACAO: SOMAS ENFILEIRADAS QUE COMPLETAM UM TRABALHO (INTERRUPCAO).
+#define CFS_COLUNA(p) ((uint32_t)(p) << 4) //CONTROLE: BANCO B (COLUNA p) ESCRITO NO MODO CFS_SEL_BANCO_B.
+#define CFS_CMD_LIMPA_ACUMULADOR (1 << 8) //CONTROLE: ZERA O ACUMULADOR E O ESTOURO.
+#define CFS_CMD_ACUMULA (1 << 9)          //CONTROLE: SOMA A CADA ACUMULADOR A SOMA DA SUA COLUNA (JUNTO COM O ANTERIOR, CARREGA).
+#define CFS_CMD_RECONHECE_IRQ (1 << 10)   //CONTROLE: LIMPA A INTERRUPCAO E A CONTAGEM DE SOMAS ENFILEIRADAS.
+#define CFS_IRQ_HABILITADA (1 << 16)      //CONTROLE: INTERRUPCAO QUANDO O LIMIAR E ATINGIDO.
+#define CFS_OPERANDOS_FLOAT (1 << 17)     //CONTROLE: OS BANCOS A E B RECEBEM UM FLOAT32 POR PALAVRA (VIA n NA PALAVRA n), CONVERTIDO PARA Q8.8 NO CFS.
+#define CFS_REG_ACUMULADOR_FLOAT(p) (40 + (p)) //LEITURA: BITS 31..0 DO ACUMULADOR DA COLUNA p COMO FLOAT32 DO VALOR Q16.16.
+#define CFS_REG_SOMA_FLOAT(p) (48 + (p))       //LEITURA: SOMA DA COLUNA p (MODULO 2^32) COMO FLOAT32 DO VALOR Q16.16.
+#define CFS_OPERANDOS_INT8 (1 << 18)      //CONTROLE: OS BANCOS A E B RECEBEM QUATRO INT8 POR PALAVRA (VIAS 4n..4n+3 NOS BYTES 0..3 DA PALAVRA n); SOMAS COM SINAL.
+#define CFS_VIAS_INT8 4                   //VIAS INT8 POR PALAVRA NOS BANCOS A E B.
+#define CFS_CMD_CAPTURA_CONTADORES (1 << 11) //CONTROLE: COPIA OS CONTADORES DE DESEMPENHO PARA OS REGISTRADORES DE LEITURA.
+#define CFS_CMD_ZERA_CONTADORES (1 << 12)    //CONTROLE: ZERA OS CONTADORES DE DESEMPENHO (DEPOIS DA CAPTURA, SE AMBOS).
+#define CFS_BANCO_SOMBRA (1 << 13)     //CONTROLE: AS ESCRITAS EM A (E O a DO MODO PAR) VAO PARA O BANCO A SOMBRA, SEM REINICIAR O PIPELINE.
+#define CFS_CMD_TROCA_BANCOS (1 << 14) //CONTROLE: TROCA O BANCO A ATIVO PELO SOMBRA (DEPOIS DE CFS_CMD_ACUMULA E CFS_CMD_ENFILEIRA).
+#define CFS_CMD_ENFILEIRA (1 << 15)    //CONTROLE: COLOCA AS SOMAS NA FILA DE RESULTADOS QUANDO VALIDAS (UMA COLUNA POR CICLO).
+#define CFS_CMD_LIMPA_FILA (1 << 19)   //CONTROLE: ESVAZIA A FILA DE RESULTADOS E LIMPA O SEU ESTOURO.
+#define CFS_CONFIG_FILA 1              //CONFIGURACAO: COLUNAS ENFILEIRADAS (BITS 3..0, 0 = TODAS) E CFS_FILA_FLOAT.
+#define CFS_FILA_FLOAT (1 << 8)        //CONFIGURACAO: ENFILEIRA O FLOAT32 DE CADA SOMA (COMO CFS_REG_SOMA_FLOAT).
+#define CFS_REG_FILA 56                //LEITURA: RETIRA O PROXIMO RESULTADO DA FILA (ZERO SE ELA ESTA VAZIA).
+#define CFS_REG_ESTADO_FILA 57         //LEITURA: NIVEL, CAPACIDADE E ESTOURO DA FILA DE RESULTADOS.
+#define CFS_FILA_NIVEL(estado) ((estado) & 0xFFFF)                //ESTADO DA FILA: RESULTADOS NA FILA.
+#define CFS_FILA_CAPACIDADE(estado) (((estado) >> 16) & 0x3FFF)   //ESTADO DA FILA: CAPACIDADE (ZERO SE NAO HA FILA).
+#define CFS_FILA_ESTOURO (1u << 31)                               //ESTADO DA FILA: UM RESULTADO FOI DESCARTADO (FILA CHEIA).
+#define CFS_MODO_FLUXO (1 << 20)       //CONTROLE: AS ESCRITAS DE OPERANDOS IGNORAM O ENDERECO E VAO PARA A PROXIMA PALAVRA DO VETOR.
+#define CFS_REG_FLUXO 0                //ESCRITA: PORTA DE FLUXO, A PALAVRA SEGUINTE DO VETOR NO MODO CFS_MODO_FLUXO.
+#define CFS_CONFIG_VIAS 2              //CONFIGURACAO: VIAS DO VETOR (0 = TODAS); AS SEGUINTES VALEM ZERO E NAO PRECISAM SER ESCRITAS.
+#define CFS_REG_CONTADOR(c) (32 + (c))       //LEITURA: CONTADOR DE DESEMPENHO c NA ULTIMA CAPTURA (AS DUAS PERSONALIDADES).
+#define CFS_NUM_CONTADORES 7                 //CICLOS, OCUPADO, ESPERA, OCIOSO, ESCRITAS, LEITURAS E OPERACOES.
+#define CFS_REG_INFO 1       //LEITURA: NO PRODUTO ESCALAR, O DATAPATH (BIT 30 EM 1); NA MATRIZ SISTOLICA, DIMENSOES DO ARRANJO (BIT 31 EM 1).
+#define CFS_INFO_PRODUTO (1u << 30)                 //INFO: O PRODUTO ESCALAR INFORMA O DATAPATH (ZERO NAS VERSOES ANTIGAS).
+#define CFS_INFO_VIAS(info) ((info) & 0xFF)                      //INFO: VIAS DO PRODUTO ESCALAR.
+#define CFS_INFO_BITS_OPERANDO(info) (((info) >> 8) & 0xFF)      //INFO: BITS DE CADA OPERANDO.
+#define CFS_INFO_BITS_ACUMULADOR(info) (((info) >> 16) & 0x7F)   //INFO: BITS DE CADA ACUMULADOR.
+#define CFS_INFO_BANCO_SOMBRA (1u << 23)                         //INFO: O BANCO A E DUPLO (CFS_BANCO_SOMBRA).
+#define CFS_INFO_SAIDAS(info) ((((info) >> 24) & 0x7) + 1)       //INFO: COLUNAS DE SAIDA.
+#define CFS_INFO_ESTAGIOS(info) (((info) >> 27) & 0x7)           //INFO: ESTAGIOS DO PIPELINE.
+#define CFS_INFO_SISTOLICA (1u << 31)               //INFO: O CFS E A MATRIZ SISTOLICA (IO_CFS_CONFIG BIT 8).
+#define CFS_INFO_LINHAS(info) ((info) & 0xFF)           //INFO: LINHAS DO ARRANJO (E DO BLOCO DE C).
+#define CFS_INFO_COLUNAS(info) (((info) >> 8) & 0xFF)   //INFO: COLUNAS DO ARRANJO (E DO BLOCO DE C).
+#define CFS_INFO_PROFUNDIDADE(info) (1 << (((info) >> 16) & 0x1F)) //INFO: K MAXIMO DE UM BLOCO.
+#define CFS_SIS_REG_POSICAO 1 //SISTOLICA, ESCRITA: POSICAO k DE ESCRITA EM A E B (E ZERA A POSICAO DE LEITURA DE C).
+#define CFS_SIS_REG_A 2       //SISTOLICA, ESCRITA: A(2n, k) (BITS 15..0) E A(2n+1, k) (BITS 31..16); k AVANCA A CADA LINHAS/2 ESCRITAS.
+#define CFS_SIS_REG_B 3       //SISTOLICA, ESCRITA: B(k, 2n) (BITS 15..0) E B(k, 2n+1) (BITS 31..16); k AVANCA A CADA COLUNAS/2 ESCRITAS.
+#define CFS_SIS_REG_C 2       //SISTOLICA, LEITURA: PROXIMO ELEMENTO Q16.16 DO BLOCO DE C, LINHA A LINHA.
+#define CFS_SIS_CMD_INICIA (1 << 0)  //SISTOLICA, CONTROLE: CALCULA C = A x B PARA O BLOCO CARREGADO.
+#define CFS_SIS_CMD_ACUMULA (1 << 1) //SISTOLICA, CONTROLE: JUNTO COM O ANTERIOR, C += A x B.
+#define CFS_SIS_PROFUNDIDADE(k) ((uint32_t)(k) << 16) //SISTOLICA, CONTROLE: K DO BLOCO (0 A PROFUNDIDADE).
 #define PRINT_ACTIVATED 0
 #define myPrint neorv32_uart0_printf
 #define controlPrint if(PRINT_ACTIVATED) myPrint 
 
-float ** criarMatrizFloat(int tam);
-uint32_t ** criarMatriz32Bits(int tam);
-void destruirMatrizFloat(float ** matriz, int tam);
-void destruirMatriz32Bits(uint32_t ** matriz, int tam);
-void instanciaMatrizAleatoriamente(float ** matriz, int tam);
-void instanciaMatrizIdentidade(float ** matriz, int tam);
-void instanciaMatrizUnitaria(float ** matriz, int tam);
-void imprimirMatrizFloat(float ** matriz, int tam);
-void imprimirMatriz32Bits(uint32_t ** matriz, int tam);
-float ** multiplicarMatriz(float ** matrizA, float ** matrizB, int tam);
+#define MATRIZ_ALINHAMENTO 16 //ALINHAMENTO, EM BYTES, DO INICIO DE CADA LINHA DA MATRIZ.
+
+//PASSO, EM ELEMENTOS, DE UMA MATRIZ COM colunas ELEMENTOS DE tamElemento BYTES POR LINHA.
+#define passoMatriz(colunas, tamElemento) \
+    ((((colunas) + MATRIZ_ALINHAMENTO / (tamElemento) - 1) / (MATRIZ_ALINHAMENTO / (tamElemento))) * (MATRIZ_ALINHAMENTO / (tamElemento)))
+
+//DECLARA O ARMAZENAMENTO, COM AS LINHAS ALINHADAS, DE UMA MATRIZ FLOAT linhas x colunas (VER matrizFloatEstatica).
+#define DADOS_MATRIZ_FLOAT(nome, linhas, colunas) \
+    float nome[(linhas) * passoMatriz(colunas, sizeof(float))] __attribute__((aligned(MATRIZ_ALINHAMENTO)))
+
+//DIMENSOES DOS BLOCOS DA MULTIPLICACAO BLOCADA (PODEM SER REDEFINIDAS VIA USER_FLAGS).
+#ifndef BLOCO_M
+#define BLOCO_M 16
+#endif
+#ifndef BLOCO_N
+#define BLOCO_N 16
+#endif
+#ifndef BLOCO_K
+#define BLOCO_K 32
+#endif
+#define MICRO_BLOCO 4 //LADO DO MICRO-BLOCO MANTIDO EM REGISTRADORES (4x4 ACUMULADORES).
+
+#if (BLOCO_M % MICRO_BLOCO) != 0 || (BLOCO_N % MICRO_BLOCO) != 0
+#error "BLOCO_M e BLOCO_N devem ser multiplos de MICRO_BLOCO"
+#endif
+
+//ACESSA O ELEMENTO (i, j) DE QUALQUER MATRIZ (OU VISAO) CONTIGUA.
+#define elementoMatriz(matriz, i, j) ((matriz)->dados[(i) * (matriz)->passo + (j)])
+
+//MATRIZ DE INTEIROS DE 32 BITS ARMAZENADA EM UM UNICO BUFFER CONTIGUO.
+typedef struct {
+    uint32_t * dados;
+    int linhas;
+    int colunas;
+    int passo;
+    uint8_t visao;
+} Matriz32Bits;
+
+//MATRIZ DE VALORES EM PONTO FIXO Q8.8 ARMAZENADA EM UM UNICO BUFFER CONTIGUO.
+typedef struct {
+    uint16_t * dados;
+    int linhas;
+    int colunas;
+    int passo;
+    uint8_t visao;
+} Matriz16Bits;
+
+//MATRIZ DE INTEIROS DE 8 BITS COM SINAL (QUANTIZACAO SIMETRICA: VALOR REAL = escala * ELEMENTO).
+typedef struct {
+    int8_t * dados;
+    int linhas;
+    int colunas;
+    int passo;
+    uint8_t visao;
+    float escala;
+} Matriz8Bits;
+
+//COPIA Q8.8 DE UMA MATRIZ FLOAT, VALIDA ENQUANTO A VERSAO DA ORIGEM NAO MUDAR.
+typedef struct {
+    Matriz16Bits * valores;
+    uint32_t versao;        //VERSAO DA MATRIZ FLOAT A PARTIR DA QUAL valores FOI GERADA.
+    Matriz16Bits estatica;  //valores DE UM CACHE SEM ALOCACAO (VER cacheEstaticoMatrizFloat).
+} MatrizQuantizada;
+
+//DECLARA O ARMAZENAMENTO DO CACHE Q8.8 DE UMA MATRIZ ESTATICA linhas x colunas (VER cacheEstaticoMatrizFloat).
+#define DADOS_MATRIZ_Q88(nome, linhas, colunas) \
+    uint16_t nome[(linhas) * passoMatriz(colunas, sizeof(uint16_t))] __attribute__((aligned(MATRIZ_ALINHAMENTO)))
+
+//MATRIZ DE FLOATS ARMAZENADA EM UM UNICO BUFFER CONTIGUO.
+//QUEM ESCREVER DIRETAMENTE EM dados DEVE CHAMAR marcarMatrizAlterada() PARA INVALIDAR O CACHE Q8.8.
+//O CACHE PERTENCE A MATRIZ DONA DOS DADOS: UMA VISAO NUNCA ALOCA CACHE, USA UM SUB-BLOCO DO CACHE DA dona.
+typedef struct MatrizFloat {
+    float * dados;  //PRIMEIRO ELEMENTO DA MATRIZ (OU DO SUB-BLOCO, NO CASO DE UMA VISAO).
+    int linhas;
+    int colunas;
+    int passo;      //DISTANCIA, EM ELEMENTOS, ENTRE O INICIO DE DUAS LINHAS CONSECUTIVAS.
+    uint8_t visao;  //1 QUANDO A MATRIZ NAO POSSUI (NAO LIBERA) OS DADOS: VISOES E MATRIZES ESTATICAS.
+    uint32_t versao;                //INCREMENTADA A CADA ALTERACAO DOS DADOS.
+    MatrizQuantizada * quantizada;  //CACHE Q8.8, CRIADO NA PRIMEIRA MULTIPLICACAO (NULL EM UMA VISAO).
+    struct MatrizFloat * dona;      //MATRIZ DE ONDE A VISAO FOI TIRADA (NULL SE NAO FOR UMA VISAO).
+    Matriz16Bits visaoQuantizada;   //SUB-BLOCO DO CACHE DA dona DEVOLVIDO POR obterMatrizQuantizada().
+} MatrizFloat;
+
+//ASSINATURA COMUM DAS IMPLEMENTACOES DE MULTIPLICACAO EM SOFTWARE.
+typedef MatrizFloat * (*FuncaoMultiplicacao)(const MatrizFloat * matrizA, const MatrizFloat * matrizB);
+
+MatrizFloat * criarMatrizFloat(int linhas, int colunas);
+Matriz32Bits * criarMatriz32Bits(int linhas, int colunas);
+Matriz16Bits * criarMatriz16Bits(int linhas, int colunas);
+Matriz8Bits * criarMatriz8Bits(int linhas, int colunas);
+MatrizFloat matrizFloatEstatica(float * dados, int linhas, int colunas);
+void cacheEstaticoMatrizFloat(MatrizFloat * matriz, MatrizQuantizada * cache, uint16_t * dados);
+MatrizFloat visaoMatrizFloat(const MatrizFloat * matriz, int linha, int coluna, int linhas, int colunas);
+Matriz32Bits visaoMatriz32Bits(const Matriz32Bits * matriz, int linha, int coluna, int linhas, int colunas);
+Matriz16Bits visaoMatriz16Bits(const Matriz16Bits * matriz, int linha, int coluna, int linhas, int colunas);
+void destruirMatrizFloat(MatrizFloat * matriz);
+void destruirMatriz32Bits(Matriz32Bits * matriz);
+void destruirMatriz16Bits(Matriz16Bits * matriz);
+void destruirMatriz8Bits(Matriz8Bits * matriz);
+void converteMatrizParaPontoFixo(const MatrizFloat * origem, Matriz16Bits * destino);
+void marcarMatrizAlterada(MatrizFloat * matriz);
+const Matriz16Bits * obterMatrizQuantizada(const MatrizFloat * matriz);
+void instanciaMatrizAleatoriamente(MatrizFloat * matriz);
+void instanciaMatrizIdentidade(MatrizFloat * matriz);
+void instanciaMatrizUnitaria(MatrizFloat * matriz);
+void imprimirMatrizFloat(const MatrizFloat * matriz);
+void imprimirMatriz32Bits(const Matriz32Bits * matriz);
+MatrizFloat * multiplicarMatriz(const MatrizFloat * matrizA, const MatrizFloat * matrizB);
+MatrizFloat * multiplicarMatrizBlocada(const MatrizFloat * matrizA, const MatrizFloat * matrizB);
+MatrizFloat * multiplicarMatrizPontoFixo(const Matriz16Bits * matrizA, const Matriz16Bits * matrizB);
+MatrizFloat * multiplicarMatrizInt8(const Matriz8Bits * matrizA, const Matriz8Bits * matrizB);
 
 #endif
\ No newline at end of file
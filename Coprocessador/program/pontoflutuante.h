@@ -26,12 +26,81 @@
 #define PONTO_FLUTUANTE_H
 
 #include <neorv32.h>
+#include "matrix.h"
+
+#ifndef CFS_CONTADOR_ATIVADO
+#define CFS_CONTADOR_ATIVADO 1 //CONTA AS ESCRITAS NO BARRAMENTO DO CFS FEITAS PELO DRIVER.
+#endif
+#ifndef CFS_DMA_ATIVADO
+#define CFS_DMA_ATIVADO 1      //ESCREVE AS LINHAS DE A NO CFS PELO DMA (IO_DMA_EN), SE ELE EXISTIR.
+#endif
+#ifndef CFS_FLOAT_ATIVADO
+#define CFS_FLOAT_ATIVADO 1    //multiplica_hardware ENVIA OS FLOATS DIRETO AO CFS, QUE FAZ AS CONVERSOES (SO NO PRODUTO ESCALAR).
+#endif
+#ifndef CFS_IRQ_ATIVADA
+#define CFS_IRQ_ATIVADA 0      //ESPERA O FIM DE CADA PRODUTO (COM A FILA DE RESULTADOS) PELA INTERRUPCAO DO CFS, EM aguardaCFS().
+#endif
+#ifndef ALOCACAO_ESTATICA
+#define ALOCACAO_ESTATICA 0    //OS RASCUNHOS DOS DRIVERS SAO ESTATICOS (ATE MAX_MATRIX LINHAS), SEM malloc DURANTE A EXECUCAO.
+#endif
+
+//INSTRUCOES DA CFU (TIPO R, OPCODE custom-0, neorv32_cpu_cp_cfu.vhd): funct3 E A OPERACAO E funct7 O ACUMULADOR.
+//OS ACUMULADORES SAO DE 32 BITS (MODULO 2^32) E NAO FAZEM PARTE DO CONTEXTO DAS TAREFAS DO FREERTOS.
+#define CFU_MAC_Q88 0      //acc += a[15:0] * b[15:0] + a[31:16] * b[31:16] (DOIS PARES Q8.8); RETORNA acc.
+#define CFU_MAC_INT8 1     //acc += SOMA DOS QUATRO PRODUTOS COM SINAL DOS BYTES DE a E b; RETORNA acc.
+#define CFU_LE 2           //RETORNA acc.
+#define CFU_RETIRA 3       //RETORNA acc E ZERA O ACUMULADOR.
+#define CFU_EMPACOTA 4     //RETORNA (b[15:0] << 16) | a[15:0].
+#define CFU_ACUMULADORES 4 //ACUMULADORES DA CFU (funct7 = 0 A 3).
+
+#define cfuInstrucao(funct3, acumulador, a, b) ({                  \
+  uint32_t _rd;                                                    \
+  asm volatile (".insn r 0x0b, %[f3], %[f7], %[rd], %[rs1], %[rs2]" \
+                : [rd] "=r" (_rd)                                  \
+                : [f3] "i" (funct3), [f7] "i" (acumulador),        \
+                  [rs1] "r" ((uint32_t)(a)), [rs2] "r" ((uint32_t)(b))); \
+  _rd;                                                             \
+})
+#define cfuMacQ88(acumulador, a, b) cfuInstrucao(CFU_MAC_Q88, acumulador, a, b)
+#define cfuMacInt8(acumulador, a, b) cfuInstrucao(CFU_MAC_INT8, acumulador, a, b)
+#define cfuLeAcumulador(acumulador) cfuInstrucao(CFU_LE, acumulador, 0, 0)
+#define cfuRetiraAcumulador(acumulador) cfuInstrucao(CFU_RETIRA, acumulador, 0, 0)
+#define cfuEmpacota(baixo, alto) cfuInstrucao(CFU_EMPACOTA, 0, baixo, alto)
 
 uint16_t converteParaPontoFixo(float num);
 float converteParaFloat(uint32_t num);
 uint8_t flutuanteParaBinario(float flutuante);
 float binarioParaFlutuante(uint16_t flutuante);
-void multiplica_hardware(float **mat1, float **mat2, float **mat3);
+uint16_t converteParaPontoFixoIterativo(float num);
+float converteParaFloatIterativo(uint32_t num);
+uint8_t flutuanteParaBinarioIterativo(float flutuante);
+float binarioParaFlutuanteIterativo(uint16_t flutuante);
+int multiplica_hardware(const MatrizFloat *mat1, const MatrizFloat *mat2, MatrizFloat *mat3);
+int multiplicaHardwarePontoFixo(const Matriz16Bits *matA, const Matriz16Bits *matB, MatrizFloat *matC);
+int multiplicaHardwareFloat(const MatrizFloat *matA, const MatrizFloat *matB, MatrizFloat *matC);
+float quantizaMatrizInt8(const MatrizFloat *origem, Matriz8Bits *destino);
+int multiplicaHardwareInt8(const Matriz8Bits *matA, const Matriz8Bits *matB, MatrizFloat *matC);
+uint32_t produtoEscalarCFU(const uint16_t *a, int passoA, const uint16_t *b, int passoB, int tamanho);
+int multiplicaCFU(const Matriz16Bits *matA, const Matriz16Bits *matB, MatrizFloat *matC);
+uint32_t produtoEscalarHardware(const uint16_t *a, int passoA, const uint16_t *b, int passoB, int tamanho);
+void aguardaCFS(void);
+uint32_t obterEscritasCFS(void);
+void zerarEscritasCFS(void);
+
+//CONTADORES DE DESEMPENHO DO CFS ENTRE zerarContadoresCFS() E lerContadoresCFS().
+typedef struct {
+    uint32_t ciclos;     //CICLOS DE RELOGIO.
+    uint32_t ocupado;    //CICLOS COM O CFS CALCULANDO.
+    uint32_t espera;     //CICLOS COM UM ACESSO AO BARRAMENTO ESPERANDO O CALCULO.
+    uint32_t ocioso;     //CICLOS SEM CALCULO E SEM ACESSO AO CFS.
+    uint32_t escritas;   //ESCRITAS DE OPERANDOS (CPU OU DMA).
+    uint32_t leituras;   //LEITURAS DE RESULTADOS.
+    uint32_t operacoes;  //COMANDOS DE ACUMULACAO (PRODUTO ESCALAR) OU BLOCOS (MATRIZ SISTOLICA).
+} ContadoresCFS;
+
+void zerarContadoresCFS(void);
+void lerContadoresCFS(ContadoresCFS *contadores);
+void imprimirPerfilCFS(const ContadoresCFS *contadores);
 void print(const char * string, float valor);
 void longPrint(const char * string, double valor);
 
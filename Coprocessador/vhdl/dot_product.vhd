@@ -44,357 +44,129 @@ library ieee;
 use ieee.std_logic_1164.all;
 use ieee.numeric_std.all;
 
--- Entity that implements the dot product of two 16-bit vectors with 63 elements.
+-- Entity that implements the dot product of two vectors of LANES elements of OP_WIDTH bits each.
+-- Lane i arrives at bits 32i+31..32i of lanes_i as (a << 16) | b; only the low OP_WIDTH bits of each half
+-- are used. The products are reduced by a balanced adder tree. PIPELINE_DEPTH register stages are spread
+-- evenly over the tree (multiplier outputs first), so reg_sum_out follows the inputs after exactly
+-- PIPELINE_DEPTH clock cycles (at most one stage per tree level plus one for the multipliers; a larger
+-- PIPELINE_DEPTH only adds margin). PIPELINE_DEPTH = 0 gives the original fully combinational datapath.
+-- The sum is kept modulo 2^SUM_WIDTH; SUM_WIDTH >= 2*OP_WIDTH + log2(LANES) never loses a carry.
+-- With int8_i set, every lane holds sign-extended int8 operands instead. For OP_WIDTH = 16 the low 16 bits
+-- of each product are then the exact signed product, which is sign-extended into the tree (no extra
+-- multipliers); narrower lanes use a separate 8x8 signed multiplier.
 entity dot_product is
+  generic (
+    PIPELINE_DEPTH : natural range 0 to 7 := 0;     -- number of register stages in the datapath
+    LANES          : natural range 1 to 63 := 63;   -- number of multipliers (vector elements)
+    OP_WIDTH       : natural range 8 to 16 := 16;   -- width of the a and b operands of each lane
+    SUM_WIDTH      : natural range 32 to 64 := 38   -- width of the adder tree and of reg_sum_wide_out
+  );
   port (
-    reg_mult_in_0 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_1 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_2 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_3 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_4 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_5 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_6 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_7 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_8 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_9 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_10 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_11 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_12 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_13 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_14 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_15 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_16 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_17 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_18 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_19 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_20 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_21 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_22 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_23 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_24 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_25 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_26 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_27 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_28 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_29 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_30 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_31 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_32 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_33 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_34 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_35 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_36 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_37 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_38 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_39 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_40 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_41 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_42 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_43 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_44 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_45 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_46 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_47 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_48 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_49 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_50 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_51 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_52 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_53 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_54 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_55 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_56 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_57 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_58 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_59 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_60 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_61 : in std_ulogic_vector(31 downto 0);
-    reg_mult_in_62 : in std_ulogic_vector(31 downto 0);
+    clk_i  : in std_ulogic; -- global clock, rising edge
+    int8_i : in std_ulogic; -- lanes are sign-extended int8, products and sums are signed
+
+    lanes_i : in std_ulogic_vector(32*LANES-1 downto 0); -- (a << 16) | b of lane i at bits 32i+31..32i
 
-    reg_sum_out : out std_ulogic_vector(31 downto 0)
+    reg_sum_out      : out std_ulogic_vector(31 downto 0);          -- sum modulo 2^32
+    reg_sum_wide_out : out std_ulogic_vector(SUM_WIDTH-1 downto 0)  -- sum modulo 2^SUM_WIDTH
   );
 end entity dot_product;
 
 -- rtl -> Register Transfer Level
 architecture rtl of dot_product is
-  type reg_array is array (0 to 62) of unsigned(15 downto 0); -- 63 registers with 16 bits
+
+  -- ceil(log2(n)) --
+  function log2_ceil_f(n : natural) return natural is
+    variable l : natural := 0;
+  begin
+    while (2**l) < n loop
+      l := l + 1;
+    end loop;
+    return l;
+  end function log2_ceil_f;
+
+  type reg_array is array (0 to LANES-1) of unsigned(OP_WIDTH-1 downto 0);
   signal a : reg_array;
   signal b : reg_array;
-  
-  type result_mult_array is array (0 to 62) of unsigned(31 downto 0); -- 63 registers with 32 bits
-	signal result_mult : result_mult_array;
+  type prod_array is array (0 to LANES-1) of unsigned(2*OP_WIDTH-1 downto 0);
+  signal prod : prod_array;
+
+  -- adder tree: level 0 holds the products (padded to a power of two), level l holds tree_size_c/2^l partial sums --
+  constant tree_levels_c : natural := log2_ceil_f(LANES);
+  constant tree_size_c   : natural := 2**tree_levels_c;
+  type tree_level_t is array (0 to tree_size_c-1) of unsigned(SUM_WIDTH-1 downto 0);
+  type tree_t is array (0 to tree_levels_c) of tree_level_t;
+  signal node  : tree_t; -- combinational result of each level
+  signal stage : tree_t; -- result of each level after its (optional) pipeline register
+
+  -- true if a pipeline register follows tree level l --
+  function reg_after_level(l : natural) return boolean is
+  begin
+    return (((l+1) * PIPELINE_DEPTH) / (tree_levels_c+1)) > ((l * PIPELINE_DEPTH) / (tree_levels_c+1));
+  end function reg_after_level;
 
-	signal result_sum : unsigned(31 downto 0);
 begin
-  -- Splitting the 32-bit input into two 16-bit inputs
-  a(0) <= unsigned(reg_mult_in_0(31 downto 16));
-  b(0) <= unsigned(reg_mult_in_0(15 downto 0));
-  
-  a(1) <= unsigned(reg_mult_in_1(31 downto 16));
-  b(1) <= unsigned(reg_mult_in_1(15 downto 0));
-  
-  a(2) <= unsigned(reg_mult_in_2(31 downto 16));
-  b(2) <= unsigned(reg_mult_in_2(15 downto 0));
-  
-  a(3) <= unsigned(reg_mult_in_3(31 downto 16));
-  b(3) <= unsigned(reg_mult_in_3(15 downto 0));
-  
-  a(4) <= unsigned(reg_mult_in_4(31 downto 16));
-  b(4) <= unsigned(reg_mult_in_4(15 downto 0));
-  
-  a(5) <= unsigned(reg_mult_in_5(31 downto 16));
-  b(5) <= unsigned(reg_mult_in_5(15 downto 0));
-  
-  a(6) <= unsigned(reg_mult_in_6(31 downto 16));
-  b(6) <= unsigned(reg_mult_in_6(15 downto 0));
-  
-  a(7) <= unsigned(reg_mult_in_7(31 downto 16));
-  b(7) <= unsigned(reg_mult_in_7(15 downto 0));
-  
-  a(8) <= unsigned(reg_mult_in_8(31 downto 16));
-  b(8) <= unsigned(reg_mult_in_8(15 downto 0));
-  
-  a(9) <= unsigned(reg_mult_in_9(31 downto 16));
-  b(9) <= unsigned(reg_mult_in_9(15 downto 0));
-  
-  a(10) <= unsigned(reg_mult_in_10(31 downto 16));
-  b(10) <= unsigned(reg_mult_in_10(15 downto 0));
-  
-  a(11) <= unsigned(reg_mult_in_11(31 downto 16));
-  b(11) <= unsigned(reg_mult_in_11(15 downto 0));
-  
-  a(12) <= unsigned(reg_mult_in_12(31 downto 16));
-  b(12) <= unsigned(reg_mult_in_12(15 downto 0));
-  
-  a(13) <= unsigned(reg_mult_in_13(31 downto 16));
-  b(13) <= unsigned(reg_mult_in_13(15 downto 0));
-  
-  a(14) <= unsigned(reg_mult_in_14(31 downto 16));
-  b(14) <= unsigned(reg_mult_in_14(15 downto 0));
-  
-  a(15) <= unsigned(reg_mult_in_15(31 downto 16));
-  b(15) <= unsigned(reg_mult_in_15(15 downto 0));
-  
-  a(16) <= unsigned(reg_mult_in_16(31 downto 16));
-  b(16) <= unsigned(reg_mult_in_16(15 downto 0));
-  
-  a(17) <= unsigned(reg_mult_in_17(31 downto 16));
-  b(17) <= unsigned(reg_mult_in_17(15 downto 0));
-  
-  a(18) <= unsigned(reg_mult_in_18(31 downto 16));
-  b(18) <= unsigned(reg_mult_in_18(15 downto 0));
-  
-  a(19) <= unsigned(reg_mult_in_19(31 downto 16));
-  b(19) <= unsigned(reg_mult_in_19(15 downto 0));
-  
-  a(20) <= unsigned(reg_mult_in_20(31 downto 16));
-  b(20) <= unsigned(reg_mult_in_20(15 downto 0));
-  
-  a(21) <= unsigned(reg_mult_in_21(31 downto 16));
-  b(21) <= unsigned(reg_mult_in_21(15 downto 0));
-  
-  a(22) <= unsigned(reg_mult_in_22(31 downto 16));
-  b(22) <= unsigned(reg_mult_in_22(15 downto 0));
-  
-  a(23) <= unsigned(reg_mult_in_23(31 downto 16));
-  b(23) <= unsigned(reg_mult_in_23(15 downto 0));
-  
-  a(24) <= unsigned(reg_mult_in_24(31 downto 16));
-  b(24) <= unsigned(reg_mult_in_24(15 downto 0));
-  
-  a(25) <= unsigned(reg_mult_in_25(31 downto 16));
-  b(25) <= unsigned(reg_mult_in_25(15 downto 0));
-  
-  a(26) <= unsigned(reg_mult_in_26(31 downto 16));
-  b(26) <= unsigned(reg_mult_in_26(15 downto 0));
-  
-  a(27) <= unsigned(reg_mult_in_27(31 downto 16));
-  b(27) <= unsigned(reg_mult_in_27(15 downto 0));
-  
-  a(28) <= unsigned(reg_mult_in_28(31 downto 16));
-  b(28) <= unsigned(reg_mult_in_28(15 downto 0));
-  
-  a(29) <= unsigned(reg_mult_in_29(31 downto 16));
-  b(29) <= unsigned(reg_mult_in_29(15 downto 0));
-  
-  a(30) <= unsigned(reg_mult_in_30(31 downto 16));
-  b(30) <= unsigned(reg_mult_in_30(15 downto 0));
-  
-  a(31) <= unsigned(reg_mult_in_31(31 downto 16));
-  b(31) <= unsigned(reg_mult_in_31(15 downto 0));
-  
-  a(32) <= unsigned(reg_mult_in_32(31 downto 16));
-  b(32) <= unsigned(reg_mult_in_32(15 downto 0));
-  
-  a(33) <= unsigned(reg_mult_in_33(31 downto 16));
-  b(33) <= unsigned(reg_mult_in_33(15 downto 0));
-  
-  a(34) <= unsigned(reg_mult_in_34(31 downto 16));
-  b(34) <= unsigned(reg_mult_in_34(15 downto 0));
-  
-  a(35) <= unsigned(reg_mult_in_35(31 downto 16));
-  b(35) <= unsigned(reg_mult_in_35(15 downto 0));
-  
-  a(36) <= unsigned(reg_mult_in_36(31 downto 16));
-  b(36) <= unsigned(reg_mult_in_36(15 downto 0));
-  
-  a(37) <= unsigned(reg_mult_in_37(31 downto 16));
-  b(37) <= unsigned(reg_mult_in_37(15 downto 0));
-  
-  a(38) <= unsigned(reg_mult_in_38(31 downto 16));
-  b(38) <= unsigned(reg_mult_in_38(15 downto 0));
-  
-  a(39) <= unsigned(reg_mult_in_39(31 downto 16));
-  b(39) <= unsigned(reg_mult_in_39(15 downto 0));
-  
-  a(40) <= unsigned(reg_mult_in_40(31 downto 16));
-  b(40) <= unsigned(reg_mult_in_40(15 downto 0));
-  
-  a(41) <= unsigned(reg_mult_in_41(31 downto 16));
-  b(41) <= unsigned(reg_mult_in_41(15 downto 0));
-  
-  a(42) <= unsigned(reg_mult_in_42(31 downto 16));
-  b(42) <= unsigned(reg_mult_in_42(15 downto 0));
-  
-  a(43) <= unsigned(reg_mult_in_43(31 downto 16));
-  b(43) <= unsigned(reg_mult_in_43(15 downto 0));
-  
-  a(44) <= unsigned(reg_mult_in_44(31 downto 16));
-  b(44) <= unsigned(reg_mult_in_44(15 downto 0));
-  
-  a(45) <= unsigned(reg_mult_in_45(31 downto 16));
-  b(45) <= unsigned(reg_mult_in_45(15 downto 0));
-  
-  a(46) <= unsigned(reg_mult_in_46(31 downto 16));
-  b(46) <= unsigned(reg_mult_in_46(15 downto 0));
-  
-  a(47) <= unsigned(reg_mult_in_47(31 downto 16));
-  b(47) <= unsigned(reg_mult_in_47(15 downto 0));
-  
-  a(48) <= unsigned(reg_mult_in_48(31 downto 16));
-  b(48) <= unsigned(reg_mult_in_48(15 downto 0));
-  
-  a(49) <= unsigned(reg_mult_in_49(31 downto 16));
-  b(49) <= unsigned(reg_mult_in_49(15 downto 0));
-  
-  a(50) <= unsigned(reg_mult_in_50(31 downto 16));
-  b(50) <= unsigned(reg_mult_in_50(15 downto 0));
-  
-  a(51) <= unsigned(reg_mult_in_51(31 downto 16));
-  b(51) <= unsigned(reg_mult_in_51(15 downto 0));
-  
-  a(52) <= unsigned(reg_mult_in_52(31 downto 16));
-  b(52) <= unsigned(reg_mult_in_52(15 downto 0));
-  
-  a(53) <= unsigned(reg_mult_in_53(31 downto 16));
-  b(53) <= unsigned(reg_mult_in_53(15 downto 0));
-  
-  a(54) <= unsigned(reg_mult_in_54(31 downto 16));
-  b(54) <= unsigned(reg_mult_in_54(15 downto 0));
-  
-  a(55) <= unsigned(reg_mult_in_55(31 downto 16));
-  b(55) <= unsigned(reg_mult_in_55(15 downto 0));
-  
-  a(56) <= unsigned(reg_mult_in_56(31 downto 16));
-  b(56) <= unsigned(reg_mult_in_56(15 downto 0));
-  
-  a(57) <= unsigned(reg_mult_in_57(31 downto 16));
-  b(57) <= unsigned(reg_mult_in_57(15 downto 0));
-  
-  a(58) <= unsigned(reg_mult_in_58(31 downto 16));
-  b(58) <= unsigned(reg_mult_in_58(15 downto 0));
-  
-  a(59) <= unsigned(reg_mult_in_59(31 downto 16));
-  b(59) <= unsigned(reg_mult_in_59(15 downto 0));
-  
-  a(60) <= unsigned(reg_mult_in_60(31 downto 16));
-  b(60) <= unsigned(reg_mult_in_60(15 downto 0));
-  
-  a(61) <= unsigned(reg_mult_in_61(31 downto 16));
-  b(61) <= unsigned(reg_mult_in_61(15 downto 0));
-  
-  a(62) <= unsigned(reg_mult_in_62(31 downto 16));
-  b(62) <= unsigned(reg_mult_in_62(15 downto 0));
+  -- Splitting each 32-bit lane into its a (high half) and b (low half) operands
+  split_gen:
+  for i in 0 to LANES-1 generate
+    a(i) <= unsigned(lanes_i(32*i+16+OP_WIDTH-1 downto 32*i+16));
+    b(i) <= unsigned(lanes_i(32*i+OP_WIDTH-1 downto 32*i));
+  end generate;
 
   -- Multiplication of each element of the vectors
-  result_mult(0) <= (a(0) * b(0));
-  result_mult(1) <= (a(1) * b(1));
-  result_mult(2) <= (a(2) * b(2));
-  result_mult(3) <= (a(3) * b(3));
-  result_mult(4) <= (a(4) * b(4));
-  result_mult(5) <= (a(5) * b(5));
-  result_mult(6) <= (a(6) * b(6));
-  result_mult(7) <= (a(7) * b(7));
-  result_mult(8) <= (a(8) * b(8));
-  result_mult(9) <= (a(9) * b(9));
-  result_mult(10) <= (a(10) * b(10));
-  result_mult(11) <= (a(11) * b(11));
-  result_mult(12) <= (a(12) * b(12));
-  result_mult(13) <= (a(13) * b(13));
-  result_mult(14) <= (a(14) * b(14));
-  result_mult(15) <= (a(15) * b(15));
-  result_mult(16) <= (a(16) * b(16));
-  result_mult(17) <= (a(17) * b(17));
-  result_mult(18) <= (a(18) * b(18));
-  result_mult(19) <= (a(19) * b(19));
-  result_mult(20) <= (a(20) * b(20));
-  result_mult(21) <= (a(21) * b(21));
-  result_mult(22) <= (a(22) * b(22));
-  result_mult(23) <= (a(23) * b(23));
-  result_mult(24) <= (a(24) * b(24));
-  result_mult(25) <= (a(25) * b(25));
-  result_mult(26) <= (a(26) * b(26));
-  result_mult(27) <= (a(27) * b(27));
-  result_mult(28) <= (a(28) * b(28));
-  result_mult(29) <= (a(29) * b(29));
-  result_mult(30) <= (a(30) * b(30));
-  result_mult(31) <= (a(31) * b(31));
-  result_mult(32) <= (a(32) * b(32));
-  result_mult(33) <= (a(33) * b(33));
-  result_mult(34) <= (a(34) * b(34));
-  result_mult(35) <= (a(35) * b(35));
-  result_mult(36) <= (a(36) * b(36));
-  result_mult(37) <= (a(37) * b(37));
-  result_mult(38) <= (a(38) * b(38));
-  result_mult(39) <= (a(39) * b(39));
-  result_mult(40) <= (a(40) * b(40));
-  result_mult(41) <= (a(41) * b(41));
-  result_mult(42) <= (a(42) * b(42));
-  result_mult(43) <= (a(43) * b(43));
-  result_mult(44) <= (a(44) * b(44));
-  result_mult(45) <= (a(45) * b(45));
-  result_mult(46) <= (a(46) * b(46));
-  result_mult(47) <= (a(47) * b(47));
-  result_mult(48) <= (a(48) * b(48));
-  result_mult(49) <= (a(49) * b(49));
-  result_mult(50) <= (a(50) * b(50));
-  result_mult(51) <= (a(51) * b(51));
-  result_mult(52) <= (a(52) * b(52));
-  result_mult(53) <= (a(53) * b(53));
-  result_mult(54) <= (a(54) * b(54));
-  result_mult(55) <= (a(55) * b(55));
-  result_mult(56) <= (a(56) * b(56));
-  result_mult(57) <= (a(57) * b(57));
-  result_mult(58) <= (a(58) * b(58));
-  result_mult(59) <= (a(59) * b(59));
-  result_mult(60) <= (a(60) * b(60));
-  result_mult(61) <= (a(61) * b(61));
-  result_mult(62) <= (a(62) * b(62));
+  mult_gen:
+  for i in 0 to LANES-1 generate
+    prod(i) <= a(i) * b(i);
+    int8_low_gen:
+    if OP_WIDTH = 16 generate
+      node(0)(i) <= unsigned(resize(signed(prod(i)(15 downto 0)), SUM_WIDTH)) when (int8_i = '1') else
+                    resize(prod(i), SUM_WIDTH);
+    end generate;
+    int8_mul_gen:
+    if OP_WIDTH /= 16 generate
+      node(0)(i) <= unsigned(resize(signed(a(i)(7 downto 0)) * signed(b(i)(7 downto 0)), SUM_WIDTH)) when (int8_i = '1') else
+                    resize(prod(i), SUM_WIDTH);
+    end generate;
+  end generate;
+  pad_gen:
+  for i in LANES to tree_size_c-1 generate
+    node(0)(i) <= (others => '0');
+  end generate;
+
+  -- Balanced adder tree (each level halves the number of partial sums)
+  tree_gen:
+  for l in 1 to tree_levels_c generate
+    node_gen:
+    for n in 0 to tree_size_c-1 generate
+      node_used:
+      if n < (tree_size_c / (2**l)) generate
+        node(l)(n) <= stage(l-1)(2*n) + stage(l-1)(2*n+1);
+      end generate;
+      node_unused:
+      if n >= (tree_size_c / (2**l)) generate
+        node(l)(n) <= (others => '0');
+      end generate;
+    end generate;
+  end generate;
+
+  -- Pipeline registers
+  stage_gen:
+  for l in 0 to tree_levels_c generate
+    stage_reg:
+    if reg_after_level(l) generate
+      stage_sync: process(clk_i)
+      begin
+        if rising_edge(clk_i) then
+          stage(l) <= node(l);
+        end if;
+      end process stage_sync;
+    end generate;
+    stage_comb:
+    if not reg_after_level(l) generate
+      stage(l) <= node(l);
+    end generate;
+  end generate;
 
-  -- Sum of all the results
-  result_sum <= result_mult(0) + result_mult(1) + result_mult(2) + result_mult(3) + result_mult(4) +
-                result_mult(5) + result_mult(6) + result_mult(7) + result_mult(8) + result_mult(9) +
-                result_mult(10) + result_mult(11) + result_mult(12) + result_mult(13) + result_mult(14) +
-                result_mult(15) + result_mult(16) + result_mult(17) + result_mult(18) + result_mult(19) +
-                result_mult(20) + result_mult(21) + result_mult(22) + result_mult(23) + result_mult(24) +
-                result_mult(25) + result_mult(26) + result_mult(27) + result_mult(28) + result_mult(29) +
-                result_mult(30) + result_mult(31) + result_mult(32) + result_mult(33) + result_mult(34) +
-                result_mult(35) + result_mult(36) + result_mult(37) + result_mult(38) + result_mult(39) +
-                result_mult(40) + result_mult(41) + result_mult(42) + result_mult(43) + result_mult(44) +
-                result_mult(45) + result_mult(46) + result_mult(47) + result_mult(48) + result_mult(49) +
-                result_mult(50) + result_mult(51) + result_mult(52) + result_mult(53) + result_mult(54) +
-                result_mult(55) + result_mult(56) + result_mult(57) + result_mult(58) + result_mult(59) +
-                result_mult(60) + result_mult(61) + result_mult(62);
-	
-  reg_sum_out <= std_ulogic_vector(result_sum);  -- Resultado armazenado de volta no registrador
+  reg_sum_out      <= std_ulogic_vector(stage(tree_levels_c)(0)(31 downto 0));  -- Resultado armazenado de volta no registrador
+  reg_sum_wide_out <= std_ulogic_vector(stage(tree_levels_c)(0));
 end architecture rtl;
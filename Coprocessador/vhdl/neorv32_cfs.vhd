@@ -77,77 +77,279 @@ architecture neorv32_cfs_rtl of neorv32_cfs is
   signal cfs_reg_wr : cfs_regs_t; -- interface registers for WRITE accesses
   signal cfs_reg_rd : cfs_regs_t; -- interface registers for READ accesses
 
+  -- register map --
+  -- The datapath is set by CFS_CONFIG: L lanes (bits 21..16, 4..63, 0 = 63), operands of 16 - bits 27..24
+  -- bits and accumulators of 48 - bits 31..28 bits; the defaults (all zero) are 63 x 16-bit lanes and
+  -- 48-bit accumulators. Software reads the datapath from the capability register (word 1).
+  -- WRITE: word 63 is the control register; words 0..L-1 are operand lanes, routed by the control
+  --        register's write select: pair ((a << 16) | b per word, reset default), A bank or B bank
+  --        (two 16-bit lanes per word). There is one A bank and P = CFS_CONFIG(6:4) + 1 B banks, one
+  --        per output column; control register bits 6..4 select the B bank written in B mode (pair
+  --        mode always writes column 0). All columns share the A lanes, so software can keep P
+  --        columns of B loaded and stream rows of A through them, getting P outputs per row.
+  --        The A bank is double-buffered: with control bit 13 set, A writes (and the a half of pair
+  --        writes) go to the shadow A bank and do not restart the pipeline, so the next row can be
+  --        loaded while the sums of the active one are computed and read. Control bit 14 swaps the
+  --        active and shadow A banks and restarts the pipeline; with an accumulate or a push in the
+  --        same write, the swap comes after them.
+  --        Control bit 15 pushes the column sums into the 64-word result FIFO once they are valid, one
+  --        per cycle starting at column 0 (the write is acknowledged after the last one). Config word 1
+  --        selects what is pushed: bits 3..0 the number of columns (0 = all P), bit 8 the float32 of
+  --        each sum instead of the sum. A push to a full FIFO is dropped and sets the sticky FIFO
+  --        overflow flag; control bit 19 empties the FIFO and clears the flag.
+  --        With control bit 20 set, operand writes ignore their address and go to the word of a stream
+  --        pointer instead, so software can store a whole vector to one address (word 0). The pointer
+  --        restarts at every control write and after the last word of the vector, whose length (in
+  --        lanes) is config word 2 (0 = L). Lanes from the vector length on read as zero in every
+  --        column, so a shorter vector needs no padding writes.
+  --        Control register bits 8 (clear) and 9 (accumulate) are commands acting on the per-column
+  --        accumulators. Accumulate adds each full-width column sum once it is valid;
+  --        the control write is only acknowledged after that, so lanes can be rewritten right away.
+  --        A sum saturates at the accumulator's maximum and sets its sticky overflow flag; clear
+  --        resets both. Clear and accumulate in the same write load the accumulators with the
+  --        current sums.
+  --        Write select "11" maps the words to configuration registers instead of lanes; config word
+  --        0 is the interrupt threshold. With control bit 16 set, the interrupt is raised once at
+  --        least max(threshold, 1) column sums were pushed (stored or dropped) since the last
+  --        acknowledge, so software can raise it once at the end of a whole product. It stays pending
+  --        until control bit 10 acknowledges it, which also restarts the push count.
+  --        With control bit 17 set, A and B bank writes carry one IEEE-754 float32 per word (lane n
+  --        at word n), converted to Q8.8 by truncation (0 <= x < 256; zero, negatives and anything
+  --        out of range give 0, as converteParaPontoFixo does in software).
+  --        With control bit 18 set (and bit 17 clear), A and B bank writes carry four int8 operands per
+  --        word (lanes 4n..4n+3 in bytes 0..3 of word n, lanes from L on do not exist) and pair writes carry
+  --        two lanes per word (a of lanes 2n and 2n+1 in bytes 2 and 3, b in bytes 0 and 1), all
+  --        sign-extended into the 16-bit lanes. Products and sums are then signed, and accumulate wraps instead of
+  --        saturating; changing bit 18 restarts the pipeline like a lane write.
+  -- READ:  word 8+p is the sum of the L lane products of column p; word 63 mirrors column 0. The
+  --        sums are pipelined (CFS_CONFIG bits 2..0 select the depth); a read of a sum is only
+  --        acknowledged once the pipeline holds the result of the last lane write. Word 0 is the
+  --        status register (bit 0: result valid, bit 1: any accumulator overflow, bit 2: interrupt
+  --        pending, bit 3: active A bank), so software can also poll for the result instead of
+  --        stalling on the bus.
+  --        Word 16+2p is accumulator p bits 31..0; word 17+2p holds its upper bits in its low half and
+  --        the overflow flag in bit 31. Word 1 is the capability register (bits 7..0: L, 15..8:
+  --        operand width, 22..16: accumulator width, 23: shadow A bank, 26..24: columns - 1, 29..27:
+  --        pipeline depth, bit 30 set). Words 40+p and 48+p are accumulator p bits 31..0 and the sum of column p (both modulo 2^32) as float32 of the Q16.16 value,
+  --        rounded to nearest even; reads of 48+p are held like reads of the sums.
+  --        Word 56 pops the result FIFO (zero when empty); word 57 is the FIFO status (bits 15..0:
+  --        fill level, 29..16: capacity, 31: overflow).
+  -- Both personalities share the performance counters: control bit 11 copies the live counters to the
+  --        snapshot read at words 32..38 (cycles, busy, bus stall, idle, operand writes, result reads,
+  --        accumulates, pushes or tiles), and control bit 12 clears the live counters, after the snapshot if
+  --        both are set. The counters saturate at 2^32-1.
+  -- With CFS_CONFIG bit 8 set, the CFS is a systolic array instead (see systolic_array.vhd for its
+  -- register map); its word 1 has bit 31 set, so software can tell the two apart.
+  constant cfs_ctrl_addr_c    : std_ulogic_vector(5 downto 0) := "111111"; -- control register address
+  constant ctrl_wr_sel_lsb_c  : natural := 0; -- write select (lsb)
+  constant ctrl_wr_sel_msb_c  : natural := 1; -- write select (msb)
+  constant wr_sel_pair_c      : std_ulogic_vector(1 downto 0) := "00"; -- (a << 16) | b, one lane per word
+  constant wr_sel_a_c         : std_ulogic_vector(1 downto 0) := "01"; -- A bank, two lanes per word
+  constant wr_sel_b_c         : std_ulogic_vector(1 downto 0) := "10"; -- B bank, two lanes per word
+  constant wr_sel_cfg_c       : std_ulogic_vector(1 downto 0) := "11"; -- configuration registers
+  constant ctrl_col_sel_lsb_c : natural := 4; -- B bank written in B mode (lsb)
+  constant ctrl_col_sel_msb_c : natural := 6; -- B bank written in B mode (msb)
+  constant cfs_sum_addr_c     : std_ulogic_vector(2 downto 0) := "001"; -- words 8..15: column sums
+  constant cfs_acc_addr_c     : std_ulogic_vector(1 downto 0) := "01"; -- words 16..31: accumulators
+  constant cfs_facc_addr_c    : std_ulogic_vector(2 downto 0) := "101"; -- words 40..47: accumulators as float32
+  constant cfs_fsum_addr_c    : std_ulogic_vector(2 downto 0) := "110"; -- words 48..55: column sums as float32
+  constant ctrl_acc_clr_c     : natural := 8; -- -/w: clear accumulators and overflow flags
+  constant ctrl_acc_add_c     : natural := 9; -- -/w: add the column sums to the accumulators
+  constant ctrl_irq_ack_c     : natural := 10; -- -/w: clear the interrupt and the push count
+  constant ctrl_perf_snap_c   : natural := 11; -- -/w: snapshot the performance counters
+  constant ctrl_perf_clr_c    : natural := 12; -- -/w: clear the performance counters
+  constant ctrl_shadow_c      : natural := 13; -- r/w: A writes go to the shadow A bank
+  constant ctrl_bank_swap_c   : natural := 14; -- -/w: swap the active and shadow A banks
+  constant ctrl_fifo_push_c   : natural := 15; -- -/w: push the column sums into the result FIFO
+  constant ctrl_fifo_clr_c    : natural := 19; -- -/w: empty the result FIFO and clear its overflow flag
+  constant ctrl_stream_c      : natural := 20; -- r/w: operand writes go to the stream pointer
+  constant ctrl_float_c       : natural := 17; -- r/w: A/B bank words are float32 operands
+  constant ctrl_int8_c        : natural := 18; -- r/w: A/B bank words are four int8 operands, signed sums
+  constant ctrl_irq_en_c      : natural := 16; -- r/w: interrupt enable
+  constant cfg_irq_thres_c    : natural := 0; -- config word: pushed sums that complete a job
+  constant cfg_push_c         : natural := 1; -- config word: columns pushed (bits 3..0), as float32 (bit 8)
+  constant cfg_vec_len_c      : natural := 2; -- config word: vector length in lanes (bits 5..0), 0 = all
+  constant cfs_fifo_data_c    : natural := 56; -- read word: pop the result FIFO
+  constant cfs_fifo_stat_c    : natural := 57; -- read word: result FIFO status
+  constant status_valid_c     : natural := 0; -- r/-: sums reflect all lane writes
+  constant status_acc_ovf_c   : natural := 1; -- r/-: an accumulator saturated
+  constant status_irq_c       : natural := 2; -- r/-: interrupt pending
+  constant status_bank_c      : natural := 3; -- r/-: active A bank
+
+  -- personality --
+  constant systolic_en_c : boolean := (CFS_CONFIG(8) = '1'); -- systolic array instead of dot products
+  signal dp_rsp : bus_rsp_t; -- response of the dot product register map
+  signal sa_rsp : bus_rsp_t; -- response of the systolic array
+  signal pers_rsp : bus_rsp_t; -- response of the selected personality
+
+  -- performance counters --
+  constant evt_busy_c  : natural := 0; -- the datapath is computing
+  constant evt_stall_c : natural := 1; -- a bus access waits for the datapath
+  constant evt_write_c : natural := 2; -- operand write (CPU or DMA)
+  constant evt_read_c  : natural := 3; -- result read
+  constant evt_op_c    : natural := 4; -- accumulate command / tile start
+  constant perf_num_c  : natural := 7; -- cycles, busy, stall, idle, writes, reads, operations
+  type perf_t is array (0 to perf_num_c-1) of unsigned(31 downto 0);
+  signal dp_evt, sa_evt, evt : std_ulogic_vector(4 downto 0);
+  signal perf_inc  : std_ulogic_vector(perf_num_c-1 downto 0); -- counters that count this cycle
+  signal perf_cnt  : perf_t; -- live counters
+  signal perf_snap : perf_t; -- counters as of the last snapshot
+  signal perf_rd   : std_ulogic_vector(31 downto 0); -- snapshot read, zero if not addressed
+
+  -- dot product datapath: CFS_CONFIG bits 21..16 = lanes (0 = 63), 27..24 = 16 - operand width,
+  -- 31..28 = 48 - accumulator width; the column sums never lose a carry --
+  constant cfg_lanes_c      : natural := to_integer(unsigned(CFS_CONFIG(21 downto 16)));
+  constant num_lanes_c      : natural := cfg_lanes_c + 63 * boolean'pos(cfg_lanes_c = 0);
+  constant op_width_c       : natural := 16 - to_integer(unsigned(CFS_CONFIG(27 downto 24)));
+  constant acc_width_c      : natural := 48 - to_integer(unsigned(CFS_CONFIG(31 downto 28)));
+  constant sum_bits_c       : natural := 2*op_width_c + index_size_f(num_lanes_c);
+  constant sum_width_c      : natural := sum_bits_c + (32 - sum_bits_c) * boolean'pos(sum_bits_c < 32);
+
+  -- dot product pipeline --
+  constant pipeline_depth_c : natural := to_integer(unsigned(CFS_CONFIG(2 downto 0)));
+  signal pipe_cnt     : unsigned(2 downto 0); -- cycles until the sum reflects the last lane write
+  signal result_valid : std_ulogic;
+  signal result_pend  : std_ulogic; -- read of a sum waiting for the pipeline
+  signal result_addr  : std_ulogic_vector(5 downto 0); -- word of the pending read
+
+  -- output columns --
+  constant num_cols_c : natural := to_integer(unsigned(CFS_CONFIG(6 downto 4))) + 1;
+  type lane_half_t is array (0 to num_lanes_c-1) of std_ulogic_vector(15 downto 0);
+  type a_banks_t is array (0 to 1) of lane_half_t;
+  type b_banks_t is array (0 to 7) of lane_half_t;
+  signal a_bank   : a_banks_t; -- active and shadow A banks
+  signal a_act    : lane_half_t; -- active A bank
+  signal a_vec    : lane_half_t; -- active A bank, zero from the vector length on
+  signal bank_act : std_ulogic; -- index of the active A bank
+  signal b_bank   : b_banks_t; -- B banks, one per column
+  type col_vec_t is array (0 to 7) of std_ulogic_vector(32*num_lanes_c-1 downto 0);
+  signal col_vec : col_vec_t; -- (a << 16) | b of lane i at bits 32i+31..32i, for every column
+  type col_sum_t is array (0 to 7) of std_ulogic_vector(31 downto 0);
+  type col_sum_wide_t is array (0 to 7) of std_ulogic_vector(sum_width_c-1 downto 0);
+  signal col_sum      : col_sum_t; -- column sums modulo 2^32
+  signal col_sum_wide : col_sum_wide_t; -- full-width column sums
+
+  -- capability register (read word 1): bits 7..0 lanes, 15..8 operand width, 22..16 accumulator width,
+  -- 23 shadow A bank, 26..24 output columns - 1, 29..27 pipeline depth, 30 always set (older builds read
+  -- zero), 31 clear --
+  constant cap_c : std_ulogic_vector(31 downto 0) := "01" &
+    std_ulogic_vector(to_unsigned(pipeline_depth_c, 3)) & std_ulogic_vector(to_unsigned(num_cols_c-1, 3)) & '1' &
+    std_ulogic_vector(to_unsigned(acc_width_c, 7)) & std_ulogic_vector(to_unsigned(op_width_c, 8)) &
+    std_ulogic_vector(to_unsigned(num_lanes_c, 8));
+
+  -- accumulators --
+  type acc_t is array (0 to 7) of unsigned(acc_width_c-1 downto 0);
+  signal acc      : acc_t;
+  signal acc_ovf  : std_ulogic_vector(7 downto 0); -- sticky saturation flags
+  signal acc_pend : std_ulogic; -- accumulate command waiting for the pipeline
+
+  -- operand stream --
+  signal vec_len   : unsigned(5 downto 0); -- config word 2
+  signal vec_lanes : natural range 1 to 63; -- lanes of the vector
+  signal strm_ptr  : unsigned(5 downto 0); -- next operand word in stream mode
+  signal strm_last : natural range 0 to 62; -- last operand word of the vector in the current packing
+
+  -- result FIFO --
+  constant fifo_depth_c : natural := 64; -- words, power of two
+  type fifo_mem_t is array (0 to fifo_depth_c-1) of std_ulogic_vector(31 downto 0);
+  signal fifo_mem   : fifo_mem_t;
+  signal fifo_wp    : unsigned(index_size_f(fifo_depth_c)-1 downto 0); -- write pointer
+  signal fifo_rp    : unsigned(index_size_f(fifo_depth_c)-1 downto 0); -- read pointer
+  signal fifo_level : unsigned(index_size_f(fifo_depth_c) downto 0);
+  signal fifo_ovf   : std_ulogic; -- sticky: a push found the FIFO full
+  signal fifo_we    : std_ulogic; -- push of a column this cycle
+  signal fifo_wdata : std_ulogic_vector(31 downto 0);
+  signal push_num   : unsigned(3 downto 0); -- columns pushed, 0 = all
+  signal push_float : std_ulogic; -- push the float32 of the sums
+  signal push_pend  : std_ulogic; -- push command waiting for the pipeline or pushing
+  signal push_col   : natural range 0 to 7; -- next column pushed
+  signal swap_pend  : std_ulogic; -- bank swap after the pending accumulate/push
+
+  -- interrupt --
+  signal irq_thres : unsigned(15 downto 0); -- pushed sums that complete a job
+  signal push_cnt  : unsigned(15 downto 0); -- sums pushed since the last acknowledge (saturating)
+  signal irq_pend  : std_ulogic;
+
   -- custom entities/functions --
-  component dot_product 
+
+  -- float32 -> Q8.8: mantissa (with the implicit bit) shifted right by 15 - exponent, low 16 bits --
+  function float_to_q88_f(f : std_ulogic_vector(31 downto 0)) return std_ulogic_vector is
+    variable shift_v : integer range -113 to 142;
+  begin
+    shift_v := 142 - to_integer(unsigned(f(30 downto 23))); -- 15 - (biased exponent - 127)
+    if (f(31) = '1') or (shift_v < 0) or (shift_v > 31) then
+      return x"0000";
+    end if;
+    return std_ulogic_vector(resize(shift_right(unsigned('1' & f(22 downto 0)), shift_v), 16));
+  end function float_to_q88_f;
+
+  -- Q16.16 -> float32: integer to float rounded to nearest even, then exponent - 16 --
+  function q1616_to_float_f(q : std_ulogic_vector(31 downto 0)) return std_ulogic_vector is
+    variable lz_v   : natural range 0 to 31;
+    variable norm_v : unsigned(31 downto 0);
+    variable mant_v : unsigned(24 downto 0); -- rounding carry & 24-bit mantissa
+    variable exp_v  : unsigned(7 downto 0);
+  begin
+    if (unsigned(q) = 0) then
+      return x"00000000";
+    end if;
+    lz_v := 0;
+    for i in 0 to 31 loop -- leading zeros (the highest set bit is assigned last)
+      if (q(i) = '1') then
+        lz_v := 31 - i;
+      end if;
+    end loop;
+    norm_v := shift_left(unsigned(q), lz_v);
+    mant_v := '0' & norm_v(31 downto 8);
+    if (norm_v(7) = '1') and ((norm_v(6 downto 0) /= 0) or (norm_v(8) = '1')) then
+      mant_v := mant_v + 1;
+    end if;
+    exp_v := to_unsigned(142 - lz_v, 8); -- 127 + (31 - lz) - 16
+    if (mant_v(24) = '1') then -- rounded up to the next power of two
+      exp_v := exp_v + 1;
+    end if;
+    return '0' & std_ulogic_vector(exp_v) & std_ulogic_vector(mant_v(22 downto 0));
+  end function q1616_to_float_f;
+
+  component dot_product
+    generic (
+      PIPELINE_DEPTH : natural range 0 to 7 := 0;
+      LANES          : natural range 1 to 63 := 63;
+      OP_WIDTH       : natural range 8 to 16 := 16;
+      SUM_WIDTH      : natural range 32 to 64 := 38
+    );
     port(
-      reg_mult_in_0 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_1 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_2 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_3 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_4 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_5 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_6 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_7 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_8 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_9 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_10 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_11 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_12 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_13 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_14 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_15 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_16 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_17 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_18 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_19 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_20 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_21 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_22 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_23 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_24 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_25 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_26 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_27 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_28 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_29 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_30 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_31 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_32 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_33 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_34 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_35 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_36 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_37 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_38 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_39 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_40 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_41 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_42 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_43 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_44 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_45 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_46 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_47 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_48 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_49 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_50 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_51 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_52 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_53 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_54 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_55 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_56 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_57 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_58 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_59 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_60 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_61 : in std_ulogic_vector(31 downto 0);
-      reg_mult_in_62 : in std_ulogic_vector(31 downto 0);
-
-      reg_sum_out : out std_ulogic_vector(31 downto 0)
+      clk_i   : in std_ulogic;
+      int8_i  : in std_ulogic;
+      lanes_i : in std_ulogic_vector(32*LANES-1 downto 0);
+
+      reg_sum_out      : out std_ulogic_vector(31 downto 0);
+      reg_sum_wide_out : out std_ulogic_vector(SUM_WIDTH-1 downto 0)
+    );
+  end component;
+
+  component systolic_array
+    generic (
+      ROWS  : natural range 2 to 16 := 8;
+      COLS  : natural range 2 to 16 := 8;
+      DEPTH : natural range 2 to 4096 := 256
+    );
+    port (
+      clk_i     : in  std_ulogic;
+      rstn_i    : in  std_ulogic;
+      bus_req_i : in  bus_req_t;
+      bus_rsp_o : out bus_rsp_t;
+      evt_o     : out std_ulogic_vector(4 downto 0)
     );
   end component;
 begin
+
+  -- Sanity Checks --
+  assert not ((num_lanes_c < 4) or (op_width_c < 8) or (op_width_c > 16)) report
+    "[CFS] Dot product needs 4 to 63 lanes (CFS_CONFIG bits 21..16) and 8 to 16-bit operands (bits 27..24)." severity error;
+  assert not (acc_width_c < sum_width_c) report
+    "[CFS] Accumulators (CFS_CONFIG bits 31..28) must be at least as wide as the column sums." severity error;
+
   -- CFS IOs --
   cfs_out_o <= (others => '0'); -- not used for this minimal example
 
@@ -156,90 +358,144 @@ begin
 
 
   -- Interrupt --
-  irq_o <= '0'; -- not used for this minimal example
+  irq_o <= '0' when systolic_en_c else irq_pend; -- job done, held until acknowledged
+
+
+  -- Personality Select --
+  -- the unused personality has no outputs left and is removed by synthesis
+  pers_rsp <= sa_rsp when systolic_en_c else dp_rsp;
+  evt      <= sa_evt when systolic_en_c else dp_evt;
+
+  bus_rsp_o.ack  <= pers_rsp.ack;
+  bus_rsp_o.err  <= pers_rsp.err;
+  bus_rsp_o.data <= pers_rsp.data or perf_rd; -- both personalities read zero at the counter words
+
+  systolic_gen:
+  if systolic_en_c generate
+    systolic_inst: systolic_array
+    generic map (
+      ROWS  => 8,
+      COLS  => 8,
+      DEPTH => 256
+    )
+    port map (
+      clk_i     => clk_i,
+      rstn_i    => rstn_i,
+      bus_req_i => bus_req_i,
+      bus_rsp_o => sa_rsp,
+      evt_o     => sa_evt
+    );
+  end generate;
+
+  systolic_off_gen:
+  if not systolic_en_c generate
+    sa_rsp <= rsp_terminate_c;
+    sa_evt <= (others => '0');
+  end generate;
+
+
+  -- Performance Counters --
+  perf_inc(0) <= '1'; -- cycles
+  perf_inc(1) <= evt(evt_busy_c);
+  perf_inc(2) <= evt(evt_stall_c);
+  perf_inc(3) <= '1' when (evt(evt_busy_c) = '0') and (evt(evt_stall_c) = '0') and (bus_req_i.stb = '0') else '0'; -- idle
+  perf_inc(4) <= evt(evt_write_c);
+  perf_inc(5) <= evt(evt_read_c);
+  perf_inc(6) <= evt(evt_op_c);
+
+  perf_counters: process(rstn_i, clk_i)
+  begin
+    if (rstn_i = '0') then
+      perf_cnt  <= (others => (others => '0'));
+      perf_snap <= (others => (others => '0'));
+      perf_rd   <= (others => '0');
+    elsif rising_edge(clk_i) then
+      for c in 0 to perf_num_c-1 loop
+        if (perf_inc(c) = '1') and (perf_cnt(c) /= x"ffffffff") then
+          perf_cnt(c) <= perf_cnt(c) + 1;
+        end if;
+      end loop;
+      perf_rd <= (others => '0');
+      if (bus_req_i.stb = '1') then
+        if (bus_req_i.rw = '1') and (bus_req_i.addr(7 downto 2) = cfs_ctrl_addr_c) then
+          if (bus_req_i.data(ctrl_perf_snap_c) = '1') then
+            perf_snap <= perf_cnt;
+          end if;
+          if (bus_req_i.data(ctrl_perf_clr_c) = '1') then
+            perf_cnt <= (others => (others => '0'));
+          end if;
+        elsif (bus_req_i.rw = '0') and (unsigned(bus_req_i.addr(7 downto 2)) >= 32) and
+              (unsigned(bus_req_i.addr(7 downto 2)) < 32 + perf_num_c) then
+          perf_rd <= std_ulogic_vector(perf_snap(to_integer(unsigned(bus_req_i.addr(4 downto 2)))));
+        end if;
+      end if;
+    end if;
+  end process perf_counters;
 
 
   -- Read/Write Access --
   bus_access: process(rstn_i, clk_i)
+    variable col_v     : natural range 0 to 7;
+    variable half_v    : std_ulogic_vector(15 downto 0);
+    variable acc_sum_v : unsigned(acc_width_c downto 0); -- acc + column sum, msb = carry out
+    variable float_v   : std_ulogic; -- float32 operands
+    variable fx_v      : std_ulogic_vector(15 downto 0); -- float32 operand as Q8.8
+    variable int8_v    : std_ulogic; -- four int8 operands per word
+    variable byte_v    : std_ulogic_vector(15 downto 0); -- int8 operand of the lane, sign-extended
+    variable a_wr_v    : natural range 0 to 1; -- A bank written
+    variable waddr_v   : natural range 0 to 63; -- operand word written
+    variable last_v    : natural range 0 to 7; -- last column pushed
+    variable done_v    : std_ulogic; -- pending accumulate/push completed
   begin
     if (rstn_i = '0') then
-      cfs_reg_wr(0)  <= (others => '0');
-      cfs_reg_wr(1)  <= (others => '0');
-      cfs_reg_wr(2)  <= (others => '0');
-      cfs_reg_wr(3)  <= (others => '0');
-      cfs_reg_wr(4)  <= (others => '0');
-      cfs_reg_wr(5)  <= (others => '0');
-      cfs_reg_wr(6)  <= (others => '0');
-      cfs_reg_wr(7)  <= (others => '0');
-      cfs_reg_wr(8)  <= (others => '0');
-      cfs_reg_wr(9)  <= (others => '0');
-      cfs_reg_wr(10) <= (others => '0');
-      cfs_reg_wr(11) <= (others => '0');
-      cfs_reg_wr(12) <= (others => '0');
-      cfs_reg_wr(13) <= (others => '0');
-      cfs_reg_wr(14) <= (others => '0');
-      cfs_reg_wr(15) <= (others => '0');
-      cfs_reg_wr(16) <= (others => '0');
-      cfs_reg_wr(17) <= (others => '0');
-      cfs_reg_wr(18) <= (others => '0');
-      cfs_reg_wr(19) <= (others => '0');
-      cfs_reg_wr(20) <= (others => '0');
-      cfs_reg_wr(21) <= (others => '0');
-      cfs_reg_wr(22) <= (others => '0');
-      cfs_reg_wr(23) <= (others => '0');
-      cfs_reg_wr(24) <= (others => '0');
-      cfs_reg_wr(25) <= (others => '0');
-      cfs_reg_wr(26) <= (others => '0');
-      cfs_reg_wr(27) <= (others => '0');
-      cfs_reg_wr(28) <= (others => '0');
-      cfs_reg_wr(29) <= (others => '0');
-      cfs_reg_wr(30) <= (others => '0');
-      cfs_reg_wr(31) <= (others => '0');
-      cfs_reg_wr(32) <= (others => '0');
-      cfs_reg_wr(33) <= (others => '0');
-      cfs_reg_wr(34) <= (others => '0');
-      cfs_reg_wr(35) <= (others => '0');
-      cfs_reg_wr(36) <= (others => '0');
-      cfs_reg_wr(37) <= (others => '0');
-      cfs_reg_wr(38) <= (others => '0');
-      cfs_reg_wr(39) <= (others => '0');
-      cfs_reg_wr(40) <= (others => '0');
-      cfs_reg_wr(41) <= (others => '0');
-      cfs_reg_wr(42) <= (others => '0');
-      cfs_reg_wr(43) <= (others => '0');
-      cfs_reg_wr(44) <= (others => '0');
-      cfs_reg_wr(45) <= (others => '0');
-      cfs_reg_wr(46) <= (others => '0');
-      cfs_reg_wr(47) <= (others => '0');
-      cfs_reg_wr(48) <= (others => '0');
-      cfs_reg_wr(49) <= (others => '0');
-      cfs_reg_wr(50) <= (others => '0');
-      cfs_reg_wr(51) <= (others => '0');
-      cfs_reg_wr(52) <= (others => '0');
-      cfs_reg_wr(53) <= (others => '0');
-      cfs_reg_wr(54) <= (others => '0');
-      cfs_reg_wr(55) <= (others => '0');
-      cfs_reg_wr(56) <= (others => '0');
-      cfs_reg_wr(57) <= (others => '0');
-      cfs_reg_wr(58) <= (others => '0');
-      cfs_reg_wr(59) <= (others => '0');
-      cfs_reg_wr(60) <= (others => '0');
-      cfs_reg_wr(61) <= (others => '0');
-      cfs_reg_wr(62) <= (others => '0');
-      cfs_reg_wr(63) <= (others => '0');
-
-      bus_rsp_o.ack  <= '0';
-      bus_rsp_o.err  <= '0';
-      bus_rsp_o.data <= (others => '0');
+      cfs_reg_wr     <= (others => (others => '0'));
+
+      pipe_cnt       <= (others => '0');
+      result_pend    <= '0';
+      result_addr    <= (others => '0');
+      a_bank         <= (others => (others => (others => '0')));
+      bank_act       <= '0';
+      b_bank         <= (others => (others => (others => '0')));
+      acc            <= (others => (others => '0'));
+      acc_ovf        <= (others => '0');
+      acc_pend       <= '0';
+      fifo_wp        <= (others => '0');
+      fifo_rp        <= (others => '0');
+      fifo_level     <= (others => '0');
+      fifo_ovf       <= '0';
+      push_num       <= (others => '0');
+      push_float     <= '0';
+      push_pend      <= '0';
+      push_col       <= 0;
+      swap_pend      <= '0';
+      vec_len        <= (others => '0');
+      strm_ptr       <= (others => '0');
+      irq_thres      <= (others => '0');
+      push_cnt       <= (others => '0');
+      irq_pend       <= '0';
+      dp_rsp.ack  <= '0';
+      dp_rsp.err  <= '0';
+      dp_rsp.data <= (others => '0');
     elsif rising_edge(clk_i) then -- synchronous interface for read and write accesses
       -- transfer/access acknowledge --
-      bus_rsp_o.ack <= bus_req_i.stb;
+      dp_rsp.ack <= bus_req_i.stb;
+
+      -- pipeline drain --
+      if (pipe_cnt /= 0) then
+        pipe_cnt <= pipe_cnt - 1;
+      end if;
+
+      -- job done: enough sums pushed --
+      if (cfs_reg_wr(63)(ctrl_irq_en_c) = '1') and (push_cnt /= 0) and (push_cnt >= irq_thres) then
+        irq_pend <= '1';
+      end if;
 
       -- tie to zero if not explicitly used --
-      bus_rsp_o.err <= '0';
+      dp_rsp.err <= '0';
 
       -- defaults --
-      bus_rsp_o.data <= (others => '0'); -- the output HAS TO BE ZERO if there is no actual (read) access
+      dp_rsp.data <= (others => '0'); -- the output HAS TO BE ZERO if there is no actual (read) access
+      done_v      := '0';
 
       -- bus access --
       if (bus_req_i.stb = '1') then -- valid access cycle, STB is high for one cycle
@@ -247,221 +503,307 @@ begin
         -- write access --
         if (bus_req_i.rw = '1') then
 
-          case bus_req_i.addr(7 downto 2) is
-            when "000000" =>              cfs_reg_wr(0) <= bus_req_i.data;
-            when "000001" =>              cfs_reg_wr(1) <= bus_req_i.data;
-            when "000010" =>              cfs_reg_wr(2) <= bus_req_i.data;
-            when "000011" =>              cfs_reg_wr(3) <= bus_req_i.data;
-            when "000100" =>              cfs_reg_wr(4) <= bus_req_i.data;
-            when "000101" =>              cfs_reg_wr(5) <= bus_req_i.data;
-            when "000110" =>              cfs_reg_wr(6) <= bus_req_i.data;
-            when "000111" =>              cfs_reg_wr(7) <= bus_req_i.data;
-            when "001000" =>              cfs_reg_wr(8) <= bus_req_i.data;
-            when "001001" =>              cfs_reg_wr(9) <= bus_req_i.data;
-            when "001010" =>              cfs_reg_wr(10) <= bus_req_i.data;
-            when "001011" =>              cfs_reg_wr(11) <= bus_req_i.data;
-            when "001100" =>              cfs_reg_wr(12) <= bus_req_i.data;
-            when "001101" =>              cfs_reg_wr(13) <= bus_req_i.data;
-            when "001110" =>              cfs_reg_wr(14) <= bus_req_i.data;
-            when "001111" =>              cfs_reg_wr(15) <= bus_req_i.data;
-            when "010000" =>              cfs_reg_wr(16) <= bus_req_i.data;
-            when "010001" =>              cfs_reg_wr(17) <= bus_req_i.data;
-            when "010010" =>              cfs_reg_wr(18) <= bus_req_i.data;
-            when "010011" =>              cfs_reg_wr(19) <= bus_req_i.data;
-            when "010100" =>              cfs_reg_wr(20) <= bus_req_i.data;
-            when "010101" =>              cfs_reg_wr(21) <= bus_req_i.data;
-            when "010110" =>              cfs_reg_wr(22) <= bus_req_i.data;
-            when "010111" =>              cfs_reg_wr(23) <= bus_req_i.data;
-            when "011000" =>              cfs_reg_wr(24) <= bus_req_i.data;
-            when "011001" =>              cfs_reg_wr(25) <= bus_req_i.data;
-            when "011010" =>              cfs_reg_wr(26) <= bus_req_i.data;
-            when "011011" =>              cfs_reg_wr(27) <= bus_req_i.data;
-            when "011100" =>              cfs_reg_wr(28) <= bus_req_i.data;
-            when "011101" =>              cfs_reg_wr(29) <= bus_req_i.data;
-            when "011110" =>              cfs_reg_wr(30) <= bus_req_i.data;
-            when "011111" =>              cfs_reg_wr(31) <= bus_req_i.data;
-            when "100000" =>              cfs_reg_wr(32) <= bus_req_i.data;
-            when "100001" =>              cfs_reg_wr(33) <= bus_req_i.data;
-            when "100010" =>              cfs_reg_wr(34) <= bus_req_i.data;
-            when "100011" =>              cfs_reg_wr(35) <= bus_req_i.data;
-            when "100100" =>              cfs_reg_wr(36) <= bus_req_i.data;
-            when "100101" =>              cfs_reg_wr(37) <= bus_req_i.data;
-            when "100110" =>              cfs_reg_wr(38) <= bus_req_i.data;
-            when "100111" =>              cfs_reg_wr(39) <= bus_req_i.data;
-            when "101000" =>              cfs_reg_wr(40) <= bus_req_i.data;
-            when "101001" =>              cfs_reg_wr(41) <= bus_req_i.data;
-            when "101010" =>              cfs_reg_wr(42) <= bus_req_i.data;
-            when "101011" =>              cfs_reg_wr(43) <= bus_req_i.data;
-            when "101100" =>              cfs_reg_wr(44) <= bus_req_i.data;
-            when "101101" =>              cfs_reg_wr(45) <= bus_req_i.data;
-            when "101110" =>              cfs_reg_wr(46) <= bus_req_i.data;
-            when "101111" =>              cfs_reg_wr(47) <= bus_req_i.data;
-            when "110000" =>              cfs_reg_wr(48) <= bus_req_i.data;
-            when "110001" =>              cfs_reg_wr(49) <= bus_req_i.data;
-            when "110010" =>              cfs_reg_wr(50) <= bus_req_i.data;
-            when "110011" =>              cfs_reg_wr(51) <= bus_req_i.data;
-            when "110100" =>              cfs_reg_wr(52) <= bus_req_i.data;
-            when "110101" =>              cfs_reg_wr(53) <= bus_req_i.data;
-            when "110110" =>              cfs_reg_wr(54) <= bus_req_i.data;
-            when "110111" =>              cfs_reg_wr(55) <= bus_req_i.data;
-            when "111000" =>              cfs_reg_wr(56) <= bus_req_i.data;
-            when "111001" =>              cfs_reg_wr(57) <= bus_req_i.data;
-            when "111010" =>              cfs_reg_wr(58) <= bus_req_i.data;
-            when "111011" =>              cfs_reg_wr(59) <= bus_req_i.data;
-            when "111100" =>              cfs_reg_wr(60) <= bus_req_i.data;
-            when "111101" =>              cfs_reg_wr(61) <= bus_req_i.data;
-            when "111110" =>              cfs_reg_wr(62) <= bus_req_i.data;
-            when "111111" =>              cfs_reg_wr(63) <= bus_req_i.data;
-            when others =>              null; -- ou algum outro comportamento padrão
-          end case;
+          if (bus_req_i.addr(7 downto 2) = cfs_ctrl_addr_c) then
+            cfs_reg_wr(63) <= bus_req_i.data; -- control register
+            strm_ptr       <= (others => '0');
+            if (bus_req_i.data(ctrl_int8_c) /= cfs_reg_wr(63)(ctrl_int8_c)) then -- products changed, restart
+              pipe_cnt <= to_unsigned(pipeline_depth_c, pipe_cnt'length);
+            end if;
+            if (bus_req_i.data(ctrl_bank_swap_c) = '1') then
+              if (bus_req_i.data(ctrl_acc_add_c) = '1') or (bus_req_i.data(ctrl_fifo_push_c) = '1') then
+                swap_pend <= '1'; -- after the accumulate/push
+              else
+                bank_act <= not bank_act;
+                pipe_cnt <= to_unsigned(pipeline_depth_c, pipe_cnt'length);
+              end if;
+            end if;
+            if (bus_req_i.data(ctrl_fifo_clr_c) = '1') then
+              fifo_wp    <= (others => '0');
+              fifo_rp    <= (others => '0');
+              fifo_level <= (others => '0');
+              fifo_ovf   <= '0';
+            end if;
+            if (bus_req_i.data(ctrl_fifo_push_c) = '1') then -- acknowledged once the last sum was pushed
+              dp_rsp.ack <= '0';
+              push_pend  <= '1';
+              push_col   <= 0;
+            end if;
+            if (bus_req_i.data(ctrl_acc_clr_c) = '1') then
+              acc     <= (others => (others => '0'));
+              acc_ovf <= (others => '0');
+            end if;
+            if (bus_req_i.data(ctrl_acc_add_c) = '1') then -- acknowledged once the sum was added
+              dp_rsp.ack <= '0';
+              acc_pend      <= '1';
+            end if;
+            if (bus_req_i.data(ctrl_irq_ack_c) = '1') then
+              irq_pend <= '0';
+              push_cnt <= (others => '0');
+            end if;
+          elsif (cfs_reg_wr(63)(ctrl_wr_sel_msb_c downto ctrl_wr_sel_lsb_c) = wr_sel_cfg_c) then
+            if (to_integer(unsigned(bus_req_i.addr(7 downto 2))) = cfg_irq_thres_c) then
+              irq_thres <= unsigned(bus_req_i.data(15 downto 0));
+            end if;
+            if (to_integer(unsigned(bus_req_i.addr(7 downto 2))) = cfg_push_c) then
+              push_num   <= unsigned(bus_req_i.data(3 downto 0));
+              push_float <= bus_req_i.data(8);
+            end if;
+            if (to_integer(unsigned(bus_req_i.addr(7 downto 2))) = cfg_vec_len_c) then -- lanes changed, restart
+              vec_len  <= unsigned(bus_req_i.data(5 downto 0));
+              pipe_cnt <= to_unsigned(pipeline_depth_c, pipe_cnt'length);
+            end if;
+          else
+            if (cfs_reg_wr(63)(ctrl_wr_sel_msb_c downto ctrl_wr_sel_lsb_c) /= wr_sel_a_c) or
+               (cfs_reg_wr(63)(ctrl_shadow_c) = '0') then -- active lanes changed, restart
+              pipe_cnt <= to_unsigned(pipeline_depth_c, pipe_cnt'length);
+            end if;
+            if ((bank_act xor cfs_reg_wr(63)(ctrl_shadow_c)) = '1') then
+              a_wr_v := 1;
+            else
+              a_wr_v := 0;
+            end if;
+            if (cfs_reg_wr(63)(ctrl_stream_c) = '1') then -- next word of the vector, the address is ignored
+              waddr_v := to_integer(strm_ptr);
+              if (to_integer(strm_ptr) >= strm_last) then
+                strm_ptr <= (others => '0');
+              else
+                strm_ptr <= strm_ptr + 1;
+              end if;
+            else
+              waddr_v := to_integer(unsigned(bus_req_i.addr(7 downto 2)));
+            end if;
+            float_v := cfs_reg_wr(63)(ctrl_float_c);
+            fx_v    := float_to_q88_f(bus_req_i.data);
+            int8_v  := cfs_reg_wr(63)(ctrl_int8_c);
+            for i in 0 to num_lanes_c-1 loop
+              byte_v := std_ulogic_vector(resize(signed(bus_req_i.data(8*(i mod 4)+7 downto 8*(i mod 4))), 16));
+              case cfs_reg_wr(63)(ctrl_wr_sel_msb_c downto ctrl_wr_sel_lsb_c) is
+                when wr_sel_a_c => -- A bank: lanes 2n (bits 15..0) and 2n+1 (bits 31..16) at word n
+                  if (float_v = '1') then -- float32 of lane n at word n
+                    if (waddr_v = i) then
+                      a_bank(a_wr_v)(i) <= fx_v;
+                    end if;
+                  elsif (int8_v = '1') then -- int8 of lanes 4n..4n+3 (bytes 0..3) at word n
+                    if (waddr_v = i/4) then
+                      a_bank(a_wr_v)(i) <= byte_v;
+                    end if;
+                  elsif (waddr_v = i/2) then
+                    if ((i mod 2) = 0) then
+                      a_bank(a_wr_v)(i) <= bus_req_i.data(15 downto 0);
+                    else
+                      a_bank(a_wr_v)(i) <= bus_req_i.data(31 downto 16);
+                    end if;
+                  end if;
+                when wr_sel_b_c => -- B bank: lanes 2n (bits 15..0) and 2n+1 (bits 31..16) at word n
+                  if ((float_v = '1') and (waddr_v = i)) or
+                     ((float_v = '0') and (int8_v = '1') and (waddr_v = i/4)) or
+                     ((float_v = '0') and (int8_v = '0') and (waddr_v = i/2)) then
+                    if (float_v = '1') then
+                      half_v := fx_v;
+                    elsif (int8_v = '1') then
+                      half_v := byte_v;
+                    elsif ((i mod 2) = 0) then
+                      half_v := bus_req_i.data(15 downto 0);
+                    else
+                      half_v := bus_req_i.data(31 downto 16);
+                    end if;
+                    col_v := to_integer(unsigned(cfs_reg_wr(63)(ctrl_col_sel_msb_c downto ctrl_col_sel_lsb_c)));
+                    b_bank(col_v)(i) <= half_v;
+                  end if;
+                when others => -- pair: (a << 16) | b of lane n at word n
+                  if (int8_v = '1') then -- int8 a of lanes 2n, 2n+1 in bytes 2, 3 and b in bytes 0, 1 of word n
+                    if (waddr_v = i/2) then
+                      a_bank(a_wr_v)(i) <= std_ulogic_vector(resize(signed(bus_req_i.data(16+8*(i mod 2)+7 downto 16+8*(i mod 2))), 16));
+                      b_bank(0)(i)      <= std_ulogic_vector(resize(signed(bus_req_i.data(8*(i mod 2)+7 downto 8*(i mod 2))), 16));
+                    end if;
+                  elsif (waddr_v = i) then
+                    a_bank(a_wr_v)(i) <= bus_req_i.data(31 downto 16);
+                    b_bank(0)(i)      <= bus_req_i.data(15 downto 0);
+                  end if;
+              end case;
+            end loop;
+          end if;
+
+        -- read access: hold a sum until the pipeline has caught up --
+        elsif (result_valid = '0') and ((bus_req_i.addr(7 downto 2) = cfs_ctrl_addr_c) or
+                                        (bus_req_i.addr(7 downto 5) = cfs_sum_addr_c) or
+                                        (bus_req_i.addr(7 downto 5) = cfs_fsum_addr_c)) then
+          dp_rsp.ack  <= '0';
+          result_pend <= '1';
+          result_addr <= bus_req_i.addr(7 downto 2);
 
         -- read access --
         else 
-          case bus_req_i.addr(7 downto 2) is
-            when "000000" => bus_rsp_o.data <= cfs_reg_rd(0);
-            when "000001" => bus_rsp_o.data <= cfs_reg_rd(1);
-            when "000010" => bus_rsp_o.data <= cfs_reg_rd(2);
-            when "000011" => bus_rsp_o.data <= cfs_reg_rd(3);
-            when "000100" => bus_rsp_o.data <= cfs_reg_rd(4);
-            when "000101" => bus_rsp_o.data <= cfs_reg_rd(5);
-            when "000110" => bus_rsp_o.data <= cfs_reg_rd(6);
-            when "000111" => bus_rsp_o.data <= cfs_reg_rd(7);
-            when "001000" => bus_rsp_o.data <= cfs_reg_rd(8);
-            when "001001" => bus_rsp_o.data <= cfs_reg_rd(9);
-            when "001010" => bus_rsp_o.data <= cfs_reg_rd(10);
-            when "001011" => bus_rsp_o.data <= cfs_reg_rd(11);
-            when "001100" => bus_rsp_o.data <= cfs_reg_rd(12);
-            when "001101" => bus_rsp_o.data <= cfs_reg_rd(13);
-            when "001110" => bus_rsp_o.data <= cfs_reg_rd(14);
-            when "001111" => bus_rsp_o.data <= cfs_reg_rd(15);
-            when "010000" => bus_rsp_o.data <= cfs_reg_rd(16);
-            when "010001" => bus_rsp_o.data <= cfs_reg_rd(17);
-            when "010010" => bus_rsp_o.data <= cfs_reg_rd(18);
-            when "010011" => bus_rsp_o.data <= cfs_reg_rd(19);
-            when "010100" => bus_rsp_o.data <= cfs_reg_rd(20);
-            when "010101" => bus_rsp_o.data <= cfs_reg_rd(21);
-            when "010110" => bus_rsp_o.data <= cfs_reg_rd(22);
-            when "010111" => bus_rsp_o.data <= cfs_reg_rd(23);
-            when "011000" => bus_rsp_o.data <= cfs_reg_rd(24);
-            when "011001" => bus_rsp_o.data <= cfs_reg_rd(25);
-            when "011010" => bus_rsp_o.data <= cfs_reg_rd(26);
-            when "011011" => bus_rsp_o.data <= cfs_reg_rd(27);
-            when "011100" => bus_rsp_o.data <= cfs_reg_rd(28);
-            when "011101" => bus_rsp_o.data <= cfs_reg_rd(29);
-            when "011110" => bus_rsp_o.data <= cfs_reg_rd(30);
-            when "011111" => bus_rsp_o.data <= cfs_reg_rd(31);
-            when "100000" => bus_rsp_o.data <= cfs_reg_rd(32);
-            when "100001" => bus_rsp_o.data <= cfs_reg_rd(33);
-            when "100010" => bus_rsp_o.data <= cfs_reg_rd(34);
-            when "100011" => bus_rsp_o.data <= cfs_reg_rd(35);
-            when "100100" => bus_rsp_o.data <= cfs_reg_rd(36);
-            when "100101" => bus_rsp_o.data <= cfs_reg_rd(37);
-            when "100110" => bus_rsp_o.data <= cfs_reg_rd(38);
-            when "100111" => bus_rsp_o.data <= cfs_reg_rd(39);
-            when "101000" => bus_rsp_o.data <= cfs_reg_rd(40);
-            when "101001" => bus_rsp_o.data <= cfs_reg_rd(41);
-            when "101010" => bus_rsp_o.data <= cfs_reg_rd(42);
-            when "101011" => bus_rsp_o.data <= cfs_reg_rd(43);
-            when "101100" => bus_rsp_o.data <= cfs_reg_rd(44);
-            when "101101" => bus_rsp_o.data <= cfs_reg_rd(45);
-            when "101110" => bus_rsp_o.data <= cfs_reg_rd(46);
-            when "101111" => bus_rsp_o.data <= cfs_reg_rd(47);
-            when "110000" => bus_rsp_o.data <= cfs_reg_rd(48);
-            when "110001" => bus_rsp_o.data <= cfs_reg_rd(49);
-            when "110010" => bus_rsp_o.data <= cfs_reg_rd(50);
-            when "110011" => bus_rsp_o.data <= cfs_reg_rd(51);
-            when "110100" => bus_rsp_o.data <= cfs_reg_rd(52);
-            when "110101" => bus_rsp_o.data <= cfs_reg_rd(53);
-            when "110110" => bus_rsp_o.data <= cfs_reg_rd(54);
-            when "110111" => bus_rsp_o.data <= cfs_reg_rd(55);
-            when "111000" => bus_rsp_o.data <= cfs_reg_rd(56);
-            when "111001" => bus_rsp_o.data <= cfs_reg_rd(57);
-            when "111010" => bus_rsp_o.data <= cfs_reg_rd(58);
-            when "111011" => bus_rsp_o.data <= cfs_reg_rd(59);
-            when "111100" => bus_rsp_o.data <= cfs_reg_rd(60);
-            when "111101" => bus_rsp_o.data <= cfs_reg_rd(61);
-            when "111110" => bus_rsp_o.data <= cfs_reg_rd(62);
-            when "111111" => bus_rsp_o.data <= cfs_reg_rd(63);
-            when others   => bus_rsp_o.data <= (others => '0');
-          end case;
+          dp_rsp.data <= cfs_reg_rd(to_integer(unsigned(bus_req_i.addr(7 downto 2))));
+          if (to_integer(unsigned(bus_req_i.addr(7 downto 2))) = cfs_fifo_data_c) and (fifo_level /= 0) then -- pop
+            fifo_rp    <= fifo_rp + 1;
+            fifo_level <= fifo_level - 1;
+          end if;
+        end if;
+
+      -- delayed read of a sum --
+      elsif (result_pend = '1') and (result_valid = '1') then
+        dp_rsp.ack  <= '1';
+        dp_rsp.data <= cfs_reg_rd(to_integer(unsigned(result_addr)));
+        result_pend    <= '0';
+
+      -- delayed accumulate --
+      elsif (acc_pend = '1') and (result_valid = '1') then
+        acc_pend <= '0';
+        done_v   := not push_pend;
+        for p in 0 to num_cols_c-1 loop
+          acc_sum_v := ('0' & acc(p)) + resize(unsigned(col_sum_wide(p)), acc_sum_v'length);
+          if (cfs_reg_wr(63)(ctrl_int8_c) = '1') then -- signed sums: wrap modulo 2^acc_width_c
+            acc(p) <= unsigned(signed(acc(p)) + resize(signed(col_sum_wide(p)), acc_width_c));
+          elsif (acc_sum_v(acc_sum_v'left) = '1') then -- saturate
+            acc(p)     <= (others => '1');
+            acc_ovf(p) <= '1';
+          else
+            acc(p) <= acc_sum_v(acc_width_c-1 downto 0);
+          end if;
+        end loop;
+
+      -- delayed push: one column per cycle --
+      elsif (push_pend = '1') and (result_valid = '1') then
+        if (fifo_we = '1') then
+          fifo_wp    <= fifo_wp + 1;
+          fifo_level <= fifo_level + 1;
+        else -- full, dropped
+          fifo_ovf <= '1';
         end if;
+        if (push_cnt /= x"ffff") then
+          push_cnt <= push_cnt + 1;
+        end if;
+        if (push_num = 0) or (push_num > num_cols_c) then
+          last_v := num_cols_c - 1;
+        else
+          last_v := to_integer(push_num) - 1;
+        end if;
+        if (push_col = last_v) then
+          push_pend <= '0';
+          done_v    := '1';
+        else
+          push_col <= push_col + 1;
+        end if;
+      end if;
 
+      -- pending accumulate/push completed: acknowledge the control write, then swap --
+      if (done_v = '1') then
+        dp_rsp.ack <= '1';
+        if (swap_pend = '1') then
+          swap_pend <= '0';
+          bank_act  <= not bank_act;
+          pipe_cnt  <= to_unsigned(pipeline_depth_c, pipe_cnt'length);
+        end if;
       end if;
     end if;
   end process bus_access;
 
+  result_valid <= '1' when (pipe_cnt = 0) else '0';
+
+  -- operand stream: lanes per word are 1 (pair, float32), 2 (pair int8, Q8.8) or 4 (int8 banks) --
+  vec_lanes <= num_lanes_c when (vec_len = 0) or (vec_len > num_lanes_c) else to_integer(vec_len);
+  strm_last <= (vec_lanes - 1) / 2 when (cfs_reg_wr(63)(ctrl_wr_sel_msb_c downto ctrl_wr_sel_lsb_c) = wr_sel_pair_c) and
+                                        (cfs_reg_wr(63)(ctrl_int8_c) = '1') else
+               (vec_lanes - 1)     when (cfs_reg_wr(63)(ctrl_wr_sel_msb_c downto ctrl_wr_sel_lsb_c) = wr_sel_pair_c) or
+                                        (cfs_reg_wr(63)(ctrl_float_c) = '1') else
+               (vec_lanes - 1) / 4 when (cfs_reg_wr(63)(ctrl_int8_c) = '1') else
+               (vec_lanes - 1) / 2;
+
+  -- result FIFO memory: written in the cycles of the delayed push above that find room --
+  fifo_we    <= '1' when (bus_req_i.stb = '0') and (result_pend = '0') and (acc_pend = '0') and (push_pend = '1') and
+                         (result_valid = '1') and (fifo_level /= fifo_depth_c) else '0';
+  fifo_wdata <= cfs_reg_rd(48 + push_col) when (push_float = '1') else cfs_reg_rd(8 + push_col);
+
+  fifo_memory: process(clk_i)
+  begin
+    if rising_edge(clk_i) then
+      if (fifo_we = '1') then
+        fifo_mem(to_integer(fifo_wp)) <= fifo_wdata;
+      end if;
+    end if;
+  end process fifo_memory;
+
+  -- events for the performance counters --
+  dp_evt(evt_busy_c)  <= '1' when (pipe_cnt /= 0) or (acc_pend = '1') or (push_pend = '1') else '0';
+  dp_evt(evt_stall_c) <= result_pend or acc_pend or push_pend;
+  dp_evt(evt_write_c) <= '1' when (bus_req_i.stb = '1') and (bus_req_i.rw = '1') and (bus_req_i.addr(7 downto 2) /= cfs_ctrl_addr_c) and
+                                  (cfs_reg_wr(63)(ctrl_wr_sel_msb_c downto ctrl_wr_sel_lsb_c) /= wr_sel_cfg_c) else '0';
+  dp_evt(evt_read_c)  <= '1' when (bus_req_i.stb = '1') and (bus_req_i.rw = '0') and ((bus_req_i.addr(7 downto 2) = cfs_ctrl_addr_c) or
+                                  (bus_req_i.addr(7 downto 5) = cfs_sum_addr_c) or (bus_req_i.addr(7 downto 6) = cfs_acc_addr_c) or
+                                  (bus_req_i.addr(7 downto 5) = cfs_facc_addr_c) or (bus_req_i.addr(7 downto 5) = cfs_fsum_addr_c) or
+                                  (to_integer(unsigned(bus_req_i.addr(7 downto 2))) = cfs_fifo_data_c)) else '0';
+  dp_evt(evt_op_c)    <= '1' when (bus_req_i.stb = '1') and (bus_req_i.rw = '1') and (bus_req_i.addr(7 downto 2) = cfs_ctrl_addr_c) and
+                                  ((bus_req_i.data(ctrl_acc_add_c) = '1') or (bus_req_i.data(ctrl_fifo_push_c) = '1')) else '0';
+
+  -- status register --
+  cfs_reg_rd(0) <= (status_valid_c => result_valid, status_acc_ovf_c => or_reduce_f(acc_ovf), status_irq_c => irq_pend,
+                    status_bank_c => bank_act, others => '0');
+
+  -- column sums and accumulators readback --
+  readback_gen:
+  for p in 0 to 7 generate
+    cfs_reg_rd(8+p)    <= col_sum(p);
+    cfs_reg_rd(16+2*p) <= std_ulogic_vector(acc(p)(31 downto 0));
+    cfs_reg_rd(17+2*p) <= acc_ovf(p) & "000000000000000" & std_ulogic_vector(resize(acc(p)(acc_width_c-1 downto 32), 16));
+    cfs_reg_rd(40+p)   <= q1616_to_float_f(std_ulogic_vector(acc(p)(31 downto 0)));
+    cfs_reg_rd(48+p)   <= q1616_to_float_f(col_sum(p));
+  end generate;
+  cfs_reg_rd(63) <= col_sum(0);
+
+  -- capability register: the datapath of this build --
+  cfs_reg_rd(1) <= cap_c;
+
+  -- result FIFO: head and status --
+  cfs_reg_rd(cfs_fifo_data_c) <= fifo_mem(to_integer(fifo_rp)) when (fifo_level /= 0) else (others => '0');
+  cfs_reg_rd(cfs_fifo_stat_c) <= fifo_ovf & '0' & std_ulogic_vector(to_unsigned(fifo_depth_c, 14)) &
+                                 std_ulogic_vector(resize(fifo_level, 16));
+
+  -- unused read registers --
+  cfs_reg_rd(2 to 7)   <= (others => (others => '0'));
+  cfs_reg_rd(32 to 39) <= (others => (others => '0'));
+  cfs_reg_rd(58 to 62) <= (others => (others => '0'));
+
   -- ---------------------------------------------| 
   -- _wr é o valor que foi escrito pelo "codigo". |
   -- _rd é o valor que será lido pelo "codigo".   |
   -- ---------------------------------------------|
 
   -- CFS Function Core --
-  matrixs_multiply : dot_product port map(
-    reg_mult_in_0 => cfs_reg_wr(0),
-    reg_mult_in_1 => cfs_reg_wr(1),
-    reg_mult_in_2 => cfs_reg_wr(2),
-    reg_mult_in_3 => cfs_reg_wr(3),
-    reg_mult_in_4 => cfs_reg_wr(4),
-    reg_mult_in_5 => cfs_reg_wr(5),
-    reg_mult_in_6 => cfs_reg_wr(6),
-    reg_mult_in_7 => cfs_reg_wr(7),
-    reg_mult_in_8 => cfs_reg_wr(8),
-    reg_mult_in_9 => cfs_reg_wr(9),
-    reg_mult_in_10 => cfs_reg_wr(10),
-    reg_mult_in_11 => cfs_reg_wr(11),
-    reg_mult_in_12 => cfs_reg_wr(12),
-    reg_mult_in_13 => cfs_reg_wr(13),
-    reg_mult_in_14 => cfs_reg_wr(14),
-    reg_mult_in_15 => cfs_reg_wr(15),
-    reg_mult_in_16 => cfs_reg_wr(16),
-    reg_mult_in_17 => cfs_reg_wr(17),
-    reg_mult_in_18 => cfs_reg_wr(18),
-    reg_mult_in_19 => cfs_reg_wr(19),
-    reg_mult_in_20 => cfs_reg_wr(20),
-    reg_mult_in_21 => cfs_reg_wr(21),
-    reg_mult_in_22 => cfs_reg_wr(22),
-    reg_mult_in_23 => cfs_reg_wr(23),
-    reg_mult_in_24 => cfs_reg_wr(24),
-    reg_mult_in_25 => cfs_reg_wr(25),
-    reg_mult_in_26 => cfs_reg_wr(26),
-    reg_mult_in_27 => cfs_reg_wr(27),
-    reg_mult_in_28 => cfs_reg_wr(28),
-    reg_mult_in_29 => cfs_reg_wr(29),
-    reg_mult_in_30 => cfs_reg_wr(30),
-    reg_mult_in_31 => cfs_reg_wr(31),
-    reg_mult_in_32 => cfs_reg_wr(32),
-    reg_mult_in_33 => cfs_reg_wr(33),
-    reg_mult_in_34 => cfs_reg_wr(34),
-    reg_mult_in_35 => cfs_reg_wr(35),
-    reg_mult_in_36 => cfs_reg_wr(36),
-    reg_mult_in_37 => cfs_reg_wr(37),
-    reg_mult_in_38 => cfs_reg_wr(38),
-    reg_mult_in_39 => cfs_reg_wr(39),
-    reg_mult_in_40 => cfs_reg_wr(40),
-    reg_mult_in_41 => cfs_reg_wr(41),
-    reg_mult_in_42 => cfs_reg_wr(42),
-    reg_mult_in_43 => cfs_reg_wr(43),
-    reg_mult_in_44 => cfs_reg_wr(44),
-    reg_mult_in_45 => cfs_reg_wr(45),
-    reg_mult_in_46 => cfs_reg_wr(46),
-    reg_mult_in_47 => cfs_reg_wr(47),
-    reg_mult_in_48 => cfs_reg_wr(48),
-    reg_mult_in_49 => cfs_reg_wr(49),
-    reg_mult_in_50 => cfs_reg_wr(50),
-    reg_mult_in_51 => cfs_reg_wr(51),
-    reg_mult_in_52 => cfs_reg_wr(52),
-    reg_mult_in_53 => cfs_reg_wr(53),
-    reg_mult_in_54 => cfs_reg_wr(54),
-    reg_mult_in_55 => cfs_reg_wr(55),
-    reg_mult_in_56 => cfs_reg_wr(56),
-    reg_mult_in_57 => cfs_reg_wr(57),
-    reg_mult_in_58 => cfs_reg_wr(58),
-    reg_mult_in_59 => cfs_reg_wr(59),
-    reg_mult_in_60 => cfs_reg_wr(60),
-    reg_mult_in_61 => cfs_reg_wr(61),
-    reg_mult_in_62 => cfs_reg_wr(62),
-  
-    reg_sum_out => cfs_reg_rd(63)
-  );
+  a_act <= a_bank(1) when (bank_act = '1') else a_bank(0);
+
+  lane_gen:
+  for i in 0 to num_lanes_c-1 generate
+    a_vec(i) <= a_act(i) when (i < vec_lanes) else (others => '0');
+    col_lane_gen:
+    for p in 0 to 7 generate
+      col_vec(p)(32*i+31 downto 32*i) <= a_vec(i) & b_bank(p)(i);
+    end generate;
+  end generate;
+
+  column_gen:
+  for p in 0 to num_cols_c-1 generate
+    matrixs_multiply : dot_product
+    generic map (
+      PIPELINE_DEPTH => pipeline_depth_c,
+      LANES          => num_lanes_c,
+      OP_WIDTH       => op_width_c,
+      SUM_WIDTH      => sum_width_c
+    )
+    port map(
+      clk_i   => clk_i,
+      int8_i  => cfs_reg_wr(63)(ctrl_int8_c),
+      lanes_i => col_vec(p),
+
+      reg_sum_out      => col_sum(p),
+      reg_sum_wide_out => col_sum_wide(p)
+    );
+  end generate;
+
+  column_unused_gen:
+  for p in num_cols_c to 7 generate
+    col_sum(p)      <= (others => '0');
+    col_sum_wide(p) <= (others => '0');
+  end generate;
 	 
 end neorv32_cfs_rtl;
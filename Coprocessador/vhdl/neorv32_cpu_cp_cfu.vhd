@@ -0,0 +1,164 @@
+-- ###################################################################################################
+-- # << ISS2718 - Custom Functions Unit (CFU) for Matrix Multiplication >>                           #
+-- # *********************************************************************************************** #
+-- # This co-processor offers the multiply-accumulate datapath of the CFS as custom R-type           #
+-- # instructions in the CPU pipeline (opcode custom-0), so a dot product needs no bus transaction.  #
+-- #                                                                                                 #
+-- # NOTE: It replaces the CFU template of the NEORV32 RISC-V Processor (rtl/core), available at     #
+-- #       https://github.com/stnolting/neorv32, and is enabled by CPU_EXTENSION_RISCV_Zxcfu.        #
+-- #       Modified by Daniel Contente, Hugo Nakamura, Isaac Soares, Mateus Messias                  #
+-- # *********************************************************************************************** #
+-- # BSD 3-Clause License                                                                            #
+-- #                                                                                                 #
+-- # Hardware matrix accelerator,                                                                    #
+-- # https://github.com/ISS2718/Sistemas_Embarcados/Coprocessador                                    #
+-- #                                                                                                 #
+-- # Copyright (c) 2024, Daniel Contente, Hugo Nakamura, Isaac Soares, Mateus Messias. All rights    #
+-- # reserved.                                                                                       #
+-- #                                                                                                 #
+-- # Redistribution and use in source and binary forms, with or without modification, are            #
+-- # permitted provided that the following conditions are met:                                       #
+-- #                                                                                                 #
+-- # 1. Redistributions of source code must retain the above copyright notice, this list of          #
+-- #    conditions and the following disclaimer.                                                     #
+-- #                                                                                                 #
+-- # 2. Redistributions in binary form must reproduce the above copyright notice, this list of       #
+-- #    conditions and the following disclaimer in the documentation and/or other materials          #
+-- #    provided with the distribution.                                                              #
+-- #                                                                                                 #
+-- # 3. Neither the name of the copyright holder nor the names of its contributors may be used to    #
+-- #    endorse or promote products derived from this software without specific prior written        #
+-- #    permission.                                                                                  #
+-- #                                                                                                 #
+-- # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS     #
+-- # OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY #
+-- # AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER     #
+-- # OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR          #
+-- # CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR        #
+-- # SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY    #
+-- # THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE       #
+-- # OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE        #
+-- # POSSIBILITY OF SUCH DAMAGE.                                                                     #
+-- ###################################################################################################
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library neorv32;
+use neorv32.neorv32_package.all;
+
+-- Four 32-bit accumulators (modulo 2^32, like the Q16.16 sums of the software reference) with the
+-- multiply-accumulate operations of the CFS lanes. Every instruction completes one cycle after it
+-- starts. R3-type instructions (custom-0) only; funct7 bits 1..0 select the accumulator:
+-- funct3 000: MAC Q8.8:  acc += rs1[15:0] * rs2[15:0] + rs1[31:16] * rs2[31:16] (two unsigned pairs); rd = acc
+-- funct3 001: MAC int8:  acc += sum of the four signed byte products rs1[8b+7:8b] * rs2[8b+7:8b];     rd = acc
+-- funct3 010: read:      rd = acc
+-- funct3 011: read and clear: rd = acc, acc = 0
+-- funct3 100: pack:      rd = (rs2[15:0] << 16) | rs1[15:0] (builds a pair from two halfword loads)
+-- Other instructions (and R4-type, custom-1) return 0. The CFU CSRs are not used.
+entity neorv32_cpu_cp_cfu is
+  generic (
+    XLEN : natural -- data path width
+  );
+  port (
+    -- global control --
+    clk_i       : in  std_ulogic; -- global clock, rising edge
+    rstn_i      : in  std_ulogic; -- global reset, low-active, async
+    ctrl_i      : in  ctrl_bus_t; -- main control bus
+    start_i     : in  std_ulogic; -- trigger operation
+    -- CSR interface --
+    csr_we_i    : in  std_ulogic; -- write enable
+    csr_addr_i  : in  std_ulogic_vector(1 downto 0); -- address
+    csr_wdata_i : in  std_ulogic_vector(XLEN-1 downto 0); -- write data
+    csr_rdata_o : out std_ulogic_vector(XLEN-1 downto 0) := (others => '0'); -- read data
+    -- data input --
+    rs1_i       : in  std_ulogic_vector(XLEN-1 downto 0); -- rf source 1
+    rs2_i       : in  std_ulogic_vector(XLEN-1 downto 0); -- rf source 2
+    rs3_i       : in  std_ulogic_vector(XLEN-1 downto 0); -- rf source 3
+    -- result and status --
+    res_o       : out std_ulogic_vector(XLEN-1 downto 0) := (others => '0'); -- operation result
+    valid_o     : out std_ulogic := '0' -- data output valid
+  );
+end neorv32_cpu_cp_cfu;
+
+architecture neorv32_cpu_cp_cfu_rtl of neorv32_cpu_cp_cfu is
+
+  -- operations (funct3) --
+  constant op_mac_q88_c  : std_ulogic_vector(2 downto 0) := "000"; -- MAC of two Q8.8 pairs
+  constant op_mac_int8_c : std_ulogic_vector(2 downto 0) := "001"; -- MAC of four int8 pairs
+  constant op_read_c     : std_ulogic_vector(2 downto 0) := "010"; -- read accumulator
+  constant op_take_c     : std_ulogic_vector(2 downto 0) := "011"; -- read and clear accumulator
+  constant op_pack_c     : std_ulogic_vector(2 downto 0) := "100"; -- pack two halfwords
+
+  -- instruction fields --
+  signal r4type : std_ulogic; -- 0: R3-type (custom-0), 1: R4-type (custom-1)
+  signal funct3 : std_ulogic_vector(2 downto 0);
+  signal sel    : natural range 0 to 3; -- accumulator, funct7 bits 1..0
+
+  -- datapath --
+  type acc_t is array (0 to 3) of unsigned(31 downto 0);
+  signal acc      : acc_t;
+  signal sum_q88  : unsigned(31 downto 0); -- sum of the two Q8.8 products (modulo 2^32)
+  signal sum_int8 : unsigned(31 downto 0); -- sum of the four int8 products (two's complement)
+
+begin
+
+  -- instruction decoding --
+  r4type <= ctrl_i.ir_opcode(5);
+  funct3 <= ctrl_i.ir_funct3;
+  sel    <= to_integer(unsigned(ctrl_i.ir_funct12(6 downto 5)));
+
+  -- products --
+  sum_q88 <= (unsigned(rs1_i(15 downto 0))  * unsigned(rs2_i(15 downto 0))) +
+             (unsigned(rs1_i(31 downto 16)) * unsigned(rs2_i(31 downto 16)));
+
+  int8_products: process(rs1_i, rs2_i)
+    variable sum_v : signed(31 downto 0);
+  begin
+    sum_v := (others => '0');
+    for b in 0 to 3 loop
+      sum_v := sum_v + resize(signed(rs1_i(8*b+7 downto 8*b)) * signed(rs2_i(8*b+7 downto 8*b)), 32);
+    end loop;
+    sum_int8 <= unsigned(sum_v);
+  end process int8_products;
+
+  -- Accumulators And Result --
+  core: process(rstn_i, clk_i)
+    variable acc_v : unsigned(31 downto 0);
+  begin
+    if (rstn_i = '0') then
+      acc     <= (others => (others => '0'));
+      res_o   <= (others => '0');
+      valid_o <= '0';
+    elsif rising_edge(clk_i) then
+      res_o   <= (others => '0'); -- the output HAS TO BE ZERO when there is no valid result
+      valid_o <= start_i;
+      if (start_i = '1') and (r4type = '0') then
+        case funct3 is
+          when op_mac_q88_c =>
+            acc_v    := acc(sel) + sum_q88;
+            acc(sel) <= acc_v;
+            res_o    <= std_ulogic_vector(acc_v);
+          when op_mac_int8_c =>
+            acc_v    := acc(sel) + sum_int8;
+            acc(sel) <= acc_v;
+            res_o    <= std_ulogic_vector(acc_v);
+          when op_read_c =>
+            res_o <= std_ulogic_vector(acc(sel));
+          when op_take_c =>
+            res_o    <= std_ulogic_vector(acc(sel));
+            acc(sel) <= (others => '0');
+          when op_pack_c =>
+            res_o <= rs2_i(15 downto 0) & rs1_i(15 downto 0);
+          when others =>
+            null;
+        end case;
+      end if;
+    end if;
+  end process core;
+
+  -- CSRs not used --
+  csr_rdata_o <= (others => '0');
+
+end neorv32_cpu_cp_cfu_rtl;
@@ -84,6 +84,7 @@ begin
     CPU_EXTENSION_RISCV_C        => true,              -- implement compressed extension?
     CPU_EXTENSION_RISCV_M        => true,              -- implement mul/div extension?
     CPU_EXTENSION_RISCV_Zicntr   => true,              -- implement base counters?
+    CPU_EXTENSION_RISCV_Zxcfu    => true,              -- implement custom (instr.) functions unit (neorv32_cpu_cp_cfu.vhd)?
     -- Internal Instruction memory --
     MEM_INT_IMEM_EN              => true,              -- implement processor-internal instruction memory
     MEM_INT_IMEM_SIZE            => MEM_INT_IMEM_SIZE, -- size of processor-internal instruction memory in bytes
@@ -94,9 +95,11 @@ begin
     IO_GPIO_NUM                  => 8,                 -- number of GPIO input/output pairs (0..64)
     IO_MTIME_EN                  => true,              -- implement machine system timer (MTIME)?
     IO_UART0_EN                  => true,              -- implement primary universal asynchronous receiver/transmitter (UART0)?
+    IO_DMA_EN                    => true,              -- implement direct memory access controller (DMA)?
 
     -- Custom Functions Subsystem --
     IO_CFS_EN                    => true,              -- implement custom functions subsystem (CFS)?
+    IO_CFS_CONFIG                => x"00000033",       -- bits 2..0: dot product pipeline depth (0..7), 6..4: output columns - 1, 8: 8x8 systolic array instead, 21..16: lanes (0 = 63), 27..24: 16 - operand width, 31..28: 48 - accumulator width
     IO_CFS_IN_SIZE               => 32,                -- size of CFS input conduit in bits
     IO_CFS_OUT_SIZE              => 32                -- size of CFS output conduit in bits
  )
@@ -0,0 +1,373 @@
+-- ###################################################################################################
+-- # << ISS2718 - Systolic Array Entity for Matrix Multiplication Accelerator >>                     #
+-- # *********************************************************************************************** #
+-- # This entity implements an output-stationary systolic array of multiply-accumulate cells, fed    #
+-- # from on-chip tile buffers. It is an alternative CFS personality to the scalar product entity.   #
+-- #                                                                                                 #
+-- # NOTE: This code was entirely developed by Daniel Contente, Hugo Nakamura, Isaac Soares,         #
+-- # Mateus Messias.                                                                                 #
+-- # *********************************************************************************************** #
+-- # BSD 3-Clause License                                                                            #
+-- #                                                                                                 #
+-- # Hardware matrix accelerator,                                                                    #
+-- # https://github.com/ISS2718/Sistemas_Embarcados/Coprocessador                                    #
+-- #                                                                                                 #
+-- # Copyright (c) 2024, Daniel Contente, Hugo Nakamura, Isaac Soares, Mateus Messias. All rights    #
+-- # reserved.                                                                                       #
+-- #                                                                                                 #
+-- # Redistribution and use in source and binary forms, with or without modification, are            #
+-- # permitted provided that the following conditions are met:                                       #
+-- #                                                                                                 #
+-- # 1. Redistributions of source code must retain the above copyright notice, this list of          #
+-- #    conditions and the following disclaimer.                                                     #
+-- #                                                                                                 #
+-- # 2. Redistributions in binary form must reproduce the above copyright notice, this list of       #
+-- #    conditions and the following disclaimer in the documentation and/or other materials          #
+-- #    provided with the distribution.                                                              #
+-- #                                                                                                 #
+-- # 3. Neither the name of the copyright holder nor the names of its contributors may be used to    #
+-- #    endorse or promote products derived from this software without specific prior written        #
+-- #    permission.                                                                                  #
+-- #                                                                                                 #
+-- # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS     #
+-- # OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY #
+-- # AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER     #
+-- # OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR          #
+-- # CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR        #
+-- # SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY    #
+-- # THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE       #
+-- # OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE        #
+-- # POSSIBILITY OF SUCH DAMAGE.                                                                     #
+-- ###################################################################################################
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library neorv32;
+use neorv32.neorv32_package.all;
+
+-- Entity that computes C = A x B (or C += A x B) for one ROWS x COLS tile of C, with a tile depth of up
+-- to DEPTH, on a ROWS x COLS array of 16x16-bit MAC cells. Column k of the A tile and row k of the B tile
+-- are stored in block RAM, one RAM per array row (A) or column (B), so every edge of the array gets a new
+-- operand each cycle. A enters from the left and B from the top, each row/column delayed by its index,
+-- and every cell keeps its own 32-bit sum (modulo 2^32). A tile takes DEPTH_k + ROWS + COLS cycles to
+-- compute and ROWS * COLS cycles to copy the sums to the output buffer.
+--
+-- Register map (bus word addresses):
+-- WRITE: word 1 sets the A/B write position to row/column k = data (lane 0) and the output read position
+--        to 0. Word 2 writes A(2n, k) (bits 15..0) and A(2n+1, k) (bits 31..16) for the n-th write since
+--        k was set, moving to k+1 after ROWS/2 writes. Word 3 does the same for B(k, 2n) and B(k, 2n+1)
+--        with COLS/2 writes per k. Word 63 is the command register: bit 0 starts a tile, bit 1 keeps the
+--        previous sums (C += A x B), bits 31..16 are the tile depth K (0..DEPTH). Operand writes and
+--        commands while the array is busy are ignored.
+-- READ:  word 0 is the status register (bit 0: idle, the output buffer holds the last tile). Word 1 is
+--        the info register (bits 7..0: ROWS, 15..8: COLS, 20..16: log2(DEPTH), bit 31: always set).
+--        Word 2 returns C(i, j) of the output buffer in row-major order, one element per read.
+-- Command bits 12..11 and read words 32..38 belong to the performance counters in neorv32_cfs.vhd.
+entity systolic_array is
+  generic (
+    ROWS  : natural range 2 to 16 := 8;  -- rows of the array and of the C tile (even)
+    COLS  : natural range 2 to 16 := 8;  -- columns of the array and of the C tile (even)
+    DEPTH : natural range 2 to 4096 := 256 -- entries of each tile buffer RAM (power of two)
+  );
+  port (
+    clk_i     : in  std_ulogic; -- global clock, rising edge
+    rstn_i    : in  std_ulogic; -- global reset, low-active, async
+    bus_req_i : in  bus_req_t;  -- bus request
+    bus_rsp_o : out bus_rsp_t;  -- bus response
+    evt_o     : out std_ulogic_vector(4 downto 0) -- events: busy, bus stall, operand write, result read, tile start
+  );
+end entity systolic_array;
+
+-- rtl -> Register Transfer Level
+architecture rtl of systolic_array is
+
+  -- register map --
+  constant addr_status_c : natural := 0;  -- r/-: status
+  constant addr_ptr_c    : natural := 1;  -- r/w: info (read), buffer positions (write)
+  constant addr_port_c   : natural := 2;  -- r/w: C output (read), A tile input (write)
+  constant addr_b_c      : natural := 3;  -- -/w: B tile input
+  constant addr_cmd_c    : natural := 63; -- -/w: command
+  constant cmd_start_c   : natural := 0;  -- -/w: start a tile
+  constant cmd_acc_c     : natural := 1;  -- -/w: keep the previous sums
+
+  constant depth_log2_c : natural := index_size_f(DEPTH);
+
+  -- control --
+  type state_t is (S_IDLE, S_RUN, S_DRAIN);
+  signal state    : state_t;
+  signal cnt      : unsigned(15 downto 0); -- cycle in the current state
+  signal tile_k   : unsigned(15 downto 0); -- depth of the current tile
+  signal acc_clr  : std_ulogic; -- clear the sums (first cycle of a tile without the accumulate bit)
+  signal run      : std_ulogic;
+
+  -- tile buffer write side --
+  signal a_k, b_k     : unsigned(depth_log2_c-1 downto 0); -- k being written
+  signal a_pair       : natural range 0 to ROWS/2-1; -- lane pair being written
+  signal b_pair       : natural range 0 to COLS/2-1;
+  signal a_wr, b_wr   : std_ulogic; -- operand write strobe
+  signal wr_data      : std_ulogic_vector(31 downto 0);
+
+  -- array edges and cells --
+  type op_col_t  is array (0 to ROWS-1) of unsigned(15 downto 0);
+  type op_row_t  is array (0 to COLS-1) of unsigned(15 downto 0);
+  type op_grid_t is array (0 to ROWS-1, 0 to COLS-1) of unsigned(15 downto 0);
+  type acc_t     is array (0 to ROWS*COLS-1) of unsigned(31 downto 0);
+  signal a_edge : op_col_t; -- A entering row i (0 outside the tile)
+  signal b_edge : op_row_t; -- B entering column j (0 outside the tile)
+  signal a_pass : op_grid_t; -- A leaving cell (i, j) to the right
+  signal b_pass : op_grid_t; -- B leaving cell (i, j) downwards
+  signal acc    : acc_t; -- sum of cell (i, j) at index i*COLS + j
+
+  -- output buffer --
+  type obuf_t is array (0 to ROWS*COLS-1) of std_ulogic_vector(31 downto 0);
+  signal obuf     : obuf_t;
+  signal obuf_q   : std_ulogic_vector(31 downto 0);
+  signal out_ptr  : natural range 0 to ROWS*COLS-1;
+  signal out_pend : std_ulogic; -- read of the output port waiting for the buffer
+
+begin
+
+  -- Bus Access And Control --
+  ctrl: process(rstn_i, clk_i)
+    variable addr_v : natural range 0 to 63;
+  begin
+    if (rstn_i = '0') then
+      state          <= S_IDLE;
+      cnt            <= (others => '0');
+      tile_k         <= (others => '0');
+      acc_clr        <= '0';
+      a_k            <= (others => '0');
+      b_k            <= (others => '0');
+      a_pair         <= 0;
+      b_pair         <= 0;
+      out_ptr        <= 0;
+      out_pend       <= '0';
+      bus_rsp_o.ack  <= '0';
+      bus_rsp_o.err  <= '0';
+      bus_rsp_o.data <= (others => '0');
+    elsif rising_edge(clk_i) then
+      addr_v := to_integer(unsigned(bus_req_i.addr(7 downto 2)));
+
+      -- defaults --
+      bus_rsp_o.ack  <= bus_req_i.stb;
+      bus_rsp_o.err  <= '0';
+      bus_rsp_o.data <= (others => '0'); -- the output HAS TO BE ZERO if there is no actual (read) access
+      acc_clr        <= '0';
+
+      -- sequencer --
+      case state is
+        when S_RUN => -- the last k leaves cell (ROWS-1, COLS-1) after tile_k + ROWS + COLS - 2 cycles
+          cnt <= cnt + 1;
+          if (cnt = tile_k + (ROWS + COLS - 1)) then
+            state <= S_DRAIN;
+            cnt   <= (others => '0');
+          end if;
+        when S_DRAIN => -- copy one sum per cycle to the output buffer
+          cnt <= cnt + 1;
+          if (cnt = ROWS*COLS-1) then
+            state   <= S_IDLE;
+            out_ptr <= 0;
+          end if;
+        when others =>
+          null;
+      end case;
+
+      -- bus access --
+      if (bus_req_i.stb = '1') then
+        if (bus_req_i.rw = '1') then -- write access
+          if (addr_v = addr_ptr_c) then
+            a_k     <= unsigned(bus_req_i.data(depth_log2_c-1 downto 0));
+            b_k     <= unsigned(bus_req_i.data(depth_log2_c-1 downto 0));
+            a_pair  <= 0;
+            b_pair  <= 0;
+            out_ptr <= 0;
+          elsif (addr_v = addr_port_c) and (state = S_IDLE) then
+            if (a_pair = ROWS/2-1) then
+              a_pair <= 0;
+              a_k    <= a_k + 1;
+            else
+              a_pair <= a_pair + 1;
+            end if;
+          elsif (addr_v = addr_b_c) and (state = S_IDLE) then
+            if (b_pair = COLS/2-1) then
+              b_pair <= 0;
+              b_k    <= b_k + 1;
+            else
+              b_pair <= b_pair + 1;
+            end if;
+          elsif (addr_v = addr_cmd_c) and (state = S_IDLE) and (bus_req_i.data(cmd_start_c) = '1') then
+            state   <= S_RUN;
+            cnt     <= (others => '0');
+            tile_k  <= unsigned(bus_req_i.data(31 downto 16));
+            acc_clr <= not bus_req_i.data(cmd_acc_c);
+          end if;
+        elsif (addr_v = addr_port_c) then -- read of C: one wait state for the buffer RAM
+          bus_rsp_o.ack <= '0';
+          out_pend      <= '1';
+        elsif (addr_v = addr_status_c) then
+          if (state = S_IDLE) then
+            bus_rsp_o.data(0) <= '1';
+          end if;
+        elsif (addr_v = addr_ptr_c) then
+          bus_rsp_o.data(7 downto 0)   <= std_ulogic_vector(to_unsigned(ROWS, 8));
+          bus_rsp_o.data(15 downto 8)  <= std_ulogic_vector(to_unsigned(COLS, 8));
+          bus_rsp_o.data(20 downto 16) <= std_ulogic_vector(to_unsigned(depth_log2_c, 5));
+          bus_rsp_o.data(31)           <= '1';
+        end if;
+
+      -- delayed read of C --
+      elsif (out_pend = '1') then
+        bus_rsp_o.ack  <= '1';
+        bus_rsp_o.data <= obuf_q;
+        out_pend       <= '0';
+        if (out_ptr = ROWS*COLS-1) then
+          out_ptr <= 0;
+        else
+          out_ptr <= out_ptr + 1;
+        end if;
+      end if;
+    end if;
+  end process ctrl;
+
+  run <= '1' when (state = S_RUN) else '0';
+
+  -- events for the CFS performance counters --
+  evt_o(0) <= '0' when (state = S_IDLE) else '1';
+  evt_o(1) <= out_pend;
+  evt_o(2) <= a_wr or b_wr;
+  evt_o(3) <= '1' when (bus_req_i.stb = '1') and (bus_req_i.rw = '0') and
+                       (to_integer(unsigned(bus_req_i.addr(7 downto 2))) = addr_port_c) else '0';
+  evt_o(4) <= '1' when (bus_req_i.stb = '1') and (bus_req_i.rw = '1') and (state = S_IDLE) and (bus_req_i.data(cmd_start_c) = '1') and
+                       (to_integer(unsigned(bus_req_i.addr(7 downto 2))) = addr_cmd_c) else '0';
+
+  a_wr    <= '1' when (bus_req_i.stb = '1') and (bus_req_i.rw = '1') and (state = S_IDLE) and
+                      (to_integer(unsigned(bus_req_i.addr(7 downto 2))) = addr_port_c) else '0';
+  b_wr    <= '1' when (bus_req_i.stb = '1') and (bus_req_i.rw = '1') and (state = S_IDLE) and
+                      (to_integer(unsigned(bus_req_i.addr(7 downto 2))) = addr_b_c) else '0';
+  wr_data <= bus_req_i.data;
+
+
+  -- A Tile Buffer: one RAM per array row, row i enters the array i cycles late --
+  a_buf_gen:
+  for i in 0 to ROWS-1 generate
+    type ram_t is array (0 to DEPTH-1) of std_ulogic_vector(15 downto 0);
+    signal ram   : ram_t;
+    signal ram_q : std_ulogic_vector(15 downto 0);
+    signal rd_k  : unsigned(15 downto 0); -- k read this cycle
+    signal vld   : std_ulogic; -- ram_q belongs to the tile
+  begin
+    rd_k <= cnt - i;
+
+    a_ram: process(clk_i)
+    begin
+      if rising_edge(clk_i) then
+        if (a_wr = '1') and (a_pair = i/2) then
+          if ((i mod 2) = 0) then
+            ram(to_integer(a_k)) <= wr_data(15 downto 0);
+          else
+            ram(to_integer(a_k)) <= wr_data(31 downto 16);
+          end if;
+        end if;
+        ram_q <= ram(to_integer(rd_k(depth_log2_c-1 downto 0)));
+        if (run = '1') and (cnt >= i) and (rd_k < tile_k) then
+          vld <= '1';
+        else
+          vld <= '0';
+        end if;
+      end if;
+    end process a_ram;
+
+    a_edge(i) <= unsigned(ram_q) when (vld = '1') else (others => '0');
+  end generate;
+
+
+  -- B Tile Buffer: one RAM per array column, column j enters the array j cycles late --
+  b_buf_gen:
+  for j in 0 to COLS-1 generate
+    type ram_t is array (0 to DEPTH-1) of std_ulogic_vector(15 downto 0);
+    signal ram   : ram_t;
+    signal ram_q : std_ulogic_vector(15 downto 0);
+    signal rd_k  : unsigned(15 downto 0); -- k read this cycle
+    signal vld   : std_ulogic; -- ram_q belongs to the tile
+  begin
+    rd_k <= cnt - j;
+
+    b_ram: process(clk_i)
+    begin
+      if rising_edge(clk_i) then
+        if (b_wr = '1') and (b_pair = j/2) then
+          if ((j mod 2) = 0) then
+            ram(to_integer(b_k)) <= wr_data(15 downto 0);
+          else
+            ram(to_integer(b_k)) <= wr_data(31 downto 16);
+          end if;
+        end if;
+        ram_q <= ram(to_integer(rd_k(depth_log2_c-1 downto 0)));
+        if (run = '1') and (cnt >= j) and (rd_k < tile_k) then
+          vld <= '1';
+        else
+          vld <= '0';
+        end if;
+      end if;
+    end process b_ram;
+
+    b_edge(j) <= unsigned(ram_q) when (vld = '1') else (others => '0');
+  end generate;
+
+
+  -- MAC Cells: A moves right, B moves down, the sum stays --
+  row_gen:
+  for i in 0 to ROWS-1 generate
+    cell_gen:
+    for j in 0 to COLS-1 generate
+      signal a_in, b_in : unsigned(15 downto 0);
+    begin
+      a_first: if (j = 0) generate
+        a_in <= a_edge(i);
+      end generate;
+      a_next: if (j > 0) generate
+        a_in <= a_pass(i, j-1);
+      end generate;
+      b_first: if (i = 0) generate
+        b_in <= b_edge(j);
+      end generate;
+      b_next: if (i > 0) generate
+        b_in <= b_pass(i-1, j);
+      end generate;
+
+      mac_cell: process(rstn_i, clk_i)
+      begin
+        if (rstn_i = '0') then
+          a_pass(i, j)     <= (others => '0');
+          b_pass(i, j)     <= (others => '0');
+          acc(i*COLS + j) <= (others => '0');
+        elsif rising_edge(clk_i) then
+          if (run = '1') then
+            a_pass(i, j) <= a_in;
+            b_pass(i, j) <= b_in;
+            if (acc_clr = '1') then -- operands are still zero in the first cycle of a tile
+              acc(i*COLS + j) <= (others => '0');
+            else
+              acc(i*COLS + j) <= acc(i*COLS + j) + (a_in * b_in);
+            end if;
+          end if;
+        end if;
+      end process mac_cell;
+    end generate;
+  end generate;
+
+
+  -- Output Tile Buffer --
+  obuf_ram: process(clk_i)
+  begin
+    if rising_edge(clk_i) then
+      if (state = S_DRAIN) then
+        obuf(to_integer(cnt(index_size_f(ROWS*COLS)-1 downto 0))) <= std_ulogic_vector(acc(to_integer(cnt(index_size_f(ROWS*COLS)-1 downto 0))));
+      end if;
+      obuf_q <= obuf(out_ptr);
+    end if;
+  end process obuf_ram;
+
+end architecture rtl;
@@ -69,6 +69,15 @@
 #define configUSE_QUEUE_SETS                    ( 1 )
 #define configTASK_NOTIFICATION_ARRAY_ENTRIES   ( 4 )
 
+/* Static allocation build (make ALOCACAO_ESTATICA=1, see the makefile): the matrix tasks, their queue and
+ * matrices and the kernel's idle and timer tasks come from pre-sized pools. heap_4 is not linked and the
+ * dynamic allocation API is compiled out, so any pvPortMalloc left in the build is a link error. */
+#ifndef ALOCACAO_ESTATICA
+  #define ALOCACAO_ESTATICA                     ( 0 )
+#endif
+#define configSUPPORT_STATIC_ALLOCATION         ( ALOCACAO_ESTATICA )
+#define configSUPPORT_DYNAMIC_ALLOCATION        ( !( ALOCACAO_ESTATICA ) )
+
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES                   ( 0 )
 #define configMAX_CO_ROUTINE_PRIORITIES         ( 2 )
@@ -97,6 +106,12 @@
 #define INCLUDE_xTaskAbortDelay                 ( 1 )
 #define INCLUDE_xTaskGetHandle                  ( 1 )
 #define INCLUDE_xSemaphoreGetMutexHolder        ( 1 )
+#define INCLUDE_xTaskGetSchedulerState          ( 1 )
+#define INCLUDE_xTaskGetCurrentTaskHandle       ( 1 )
+
+/* Count context switches for the report of matrix_tasks.c. */
+extern volatile uint32_t trocasContexto;
+#define traceTASK_SWITCHED_IN()                 ( trocasContexto++ )
 
 /* Normal assert() semantics without relying on the provision of an assert.h header file. */
 void vAssertCalled( void );
@@ -35,6 +35,7 @@
 /* NEORV32 HAL */
 #include <neorv32.h>
 #include "matrix.h"
+#include "pontoflutuante.h"
 
 /* Platform UART configuration */
 #define UART_BAUD_RATE (19200)         // transmission speed
@@ -55,6 +56,12 @@ void vApplicationTickHook(void);
 /* Platform-specific prototypes */
 static void prvSetupHardware(void);
 
+/* Task notification index used by the CFS driver */
+#define CFS_NOTIFICATION_INDEX (1)
+
+/* Task blocked in aguardaCFS(), woken by the CFS interrupt */
+static TaskHandle_t xCfsTask = NULL;
+
 int main( void ) {
 
   // setup hardware
@@ -131,6 +138,16 @@ void freertos_risc_v_application_interrupt_handler(void) {
     neorv32_gptmr_trigger_matched(); // clear GPTMR timer-match interrupt
     //neorv32_uart_printf(UART_HW_HANDLE, "GPTMR IRQ Tick\n");
   }
+  else if (mcause == CFS_TRAP_CODE) { // CFS job done
+    // the CFS holds its request until the driver acknowledges it, so mask it here
+    // and let aguardaCFS() re-enable it for the next job
+    neorv32_cpu_csr_clr(CSR_MIE, 1 << CFS_FIRQ_ENABLE);
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    if (xCfsTask != NULL) {
+      vTaskNotifyGiveIndexedFromISR(xCfsTask, CFS_NOTIFICATION_INDEX, &xHigherPriorityTaskWoken);
+    }
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+  }
   else { // undefined interrupt cause
     neorv32_uart_printf(UART_HW_HANDLE, "\n<NEORV32-IRQ> Unexpected IRQ! cause=0x%x </NEORV32-IRQ>\n", mcause); // debug output
   }
@@ -189,6 +206,53 @@ void vApplicationMallocFailedHook(void) {
 }
 
 
+/******************************************************************************
+ * Wait for the CFS interrupt (replaces the polling version in pontoflutuante.c).
+ * The driver arms it once per product, so the calling task blocks on a task
+ * notification once per job while other tasks and the idle hook's sleep run.
+ ******************************************************************************/
+void aguardaCFS(void) {
+
+  // before the scheduler starts there is nobody to switch to
+  if (xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) {
+    while (!(NEORV32_CFS->REG[CFS_REG_STATUS] & CFS_STATUS_IRQ));
+    return;
+  }
+
+  xCfsTask = xTaskGetCurrentTaskHandle();
+  neorv32_cpu_csr_set(CSR_MIE, 1 << CFS_FIRQ_ENABLE); // fires right away if the job is already done
+  ulTaskNotifyTakeIndexed(CFS_NOTIFICATION_INDEX, pdTRUE, portMAX_DELAY);
+}
+
+
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+/******************************************************************************
+ * Memory of the idle and timer tasks in the static allocation build.
+ ******************************************************************************/
+void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer,
+                                   uint32_t *pulIdleTaskStackSize) {
+
+  static StaticTask_t xIdleTaskTCB;
+  static StackType_t uxIdleTaskStack[configMINIMAL_STACK_SIZE];
+
+  *ppxIdleTaskTCBBuffer = &xIdleTaskTCB;
+  *ppxIdleTaskStackBuffer = uxIdleTaskStack;
+  *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+
+void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer, StackType_t **ppxTimerTaskStackBuffer,
+                                    uint32_t *pulTimerTaskStackSize) {
+
+  static StaticTask_t xTimerTaskTCB;
+  static StackType_t uxTimerTaskStack[configTIMER_TASK_STACK_DEPTH];
+
+  *ppxTimerTaskTCBBuffer = &xTimerTaskTCB;
+  *ppxTimerTaskStackBuffer = uxTimerTaskStack;
+  *pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
+#endif
+
+
 /******************************************************************************
  * Hook for the idle process.
  ******************************************************************************/
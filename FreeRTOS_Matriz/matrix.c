@@ -25,65 +25,302 @@
 #include "matrix.h"
 #include "pontoflutuante.h"
 
-float ** criarMatrizFloat(int tam){
+//ALOCA EM UM UNICO BLOCO O CABECALHO E OS DADOS DE UMA MATRIZ, COM CADA LINHA ALINHADA.
+static void * alocaMatriz(size_t tamCabecalho, size_t tamElemento, int linhas, int colunas, int * passo, void ** dados){
+    *passo = passoMatriz(colunas, tamElemento);
+
+    size_t tamDados = (size_t) linhas * (*passo) * tamElemento;
+    uint8_t * bloco = (uint8_t *) malloc(tamCabecalho + MATRIZ_ALINHAMENTO - 1 + tamDados);
+    if(bloco == NULL)
+        return NULL;
+
+    uintptr_t inicioDados = (uintptr_t)(bloco + tamCabecalho);
+    inicioDados = (inicioDados + MATRIZ_ALINHAMENTO - 1) & ~((uintptr_t) MATRIZ_ALINHAMENTO - 1);
+    *dados = (void *) inicioDados;
+    return bloco;
+}
+
+MatrizFloat * criarMatrizFloat(int linhas, int colunas){
     controlPrint("Tentando criar uma matriz...!\n");
-    float ** matriz = (float **) malloc(tam * sizeof(float*));
+    int passo;
+    void * dados;
+    MatrizFloat * matriz = (MatrizFloat *) alocaMatriz(sizeof(MatrizFloat), sizeof(float), linhas, colunas, &passo, &dados);
     if(matriz == NULL){
         controlPrint("criarMatrizFloat(): erro ao alocar memoria para matriz.\n");
         return NULL;
     }
 
-    int i;
-    for(i = 0; i < tam; i++){
-        matriz[i] = (float *) malloc(tam * sizeof(float));
-        if(matriz[i] == NULL){
-            controlPrint("criarMatrizFloat(): erro ao alocar memoria para LINHA da matriz.\n");
-            return NULL;
-        }
-    }
+    matriz->dados = (float *) dados;
+    matriz->linhas = linhas;
+    matriz->colunas = colunas;
+    matriz->passo = passo;
+    matriz->visao = 0;
+    matriz->versao = 0;
+    matriz->quantizada = NULL;
+    matriz->dona = NULL;
     controlPrint("Matriz %u criada!\n\n", matriz);
     return matriz;
 }
 
-uint32_t ** criarMatriz32Bits(int tam){
-    uint32_t ** matriz = (uint32_t **) malloc(tam * sizeof(uint32_t*));
+Matriz32Bits * criarMatriz32Bits(int linhas, int colunas){
+    int passo;
+    void * dados;
+    Matriz32Bits * matriz = (Matriz32Bits *) alocaMatriz(sizeof(Matriz32Bits), sizeof(uint32_t), linhas, colunas, &passo, &dados);
     if(matriz == NULL){
         controlPrint("criarMatriz32Bits(): erro ao alocar memoria para matriz.\n");
         return NULL;
     }
 
-    int i;
-    for(i = 0; i < tam; i++){
-        matriz[i] = (uint32_t *) malloc(tam * sizeof(uint32_t));
-        if(matriz[i] == NULL){
-            controlPrint("criarMatriz32Bits(): erro ao alocar memoria para LINHA da matriz.\n");
-            return NULL;
-        }
+    matriz->dados = (uint32_t *) dados;
+    matriz->linhas = linhas;
+    matriz->colunas = colunas;
+    matriz->passo = passo;
+    matriz->visao = 0;
+    controlPrint("Matriz %u criada!\n\n", matriz);
+    return matriz;
+}
+
+Matriz16Bits * criarMatriz16Bits(int linhas, int colunas){
+    int passo;
+    void * dados;
+    Matriz16Bits * matriz = (Matriz16Bits *) alocaMatriz(sizeof(Matriz16Bits), sizeof(uint16_t), linhas, colunas, &passo, &dados);
+    if(matriz == NULL){
+        controlPrint("criarMatriz16Bits(): erro ao alocar memoria para matriz.\n");
+        return NULL;
     }
+
+    matriz->dados = (uint16_t *) dados;
+    matriz->linhas = linhas;
+    matriz->colunas = colunas;
+    matriz->passo = passo;
+    matriz->visao = 0;
     controlPrint("Matriz %u criada!\n\n", matriz);
     return matriz;
 }
 
-void destruirMatrizFloat(float ** matriz, int tam){
+Matriz8Bits * criarMatriz8Bits(int linhas, int colunas){
+    int passo;
+    void * dados;
+    Matriz8Bits * matriz = (Matriz8Bits *) alocaMatriz(sizeof(Matriz8Bits), sizeof(int8_t), linhas, colunas, &passo, &dados);
+    if(matriz == NULL){
+        controlPrint("criarMatriz8Bits(): erro ao alocar memoria para matriz.\n");
+        return NULL;
+    }
+
+    matriz->dados = (int8_t *) dados;
+    matriz->linhas = linhas;
+    matriz->colunas = colunas;
+    matriz->passo = passo;
+    matriz->visao = 0;
+    matriz->escala = 1.0f;
+    controlPrint("Matriz %u criada!\n\n", matriz);
+    return matriz;
+}
+
+//MATRIZ SOBRE UM ARMAZENAMENTO DECLARADO COM DADOS_MATRIZ_FLOAT, SEM ALOCACAO. COMO UMA VISAO, NAO POSSUI OS DADOS,
+//MAS NAO TEM dona: E ELA QUEM GUARDA O CACHE Q8.8 DAS SUAS VISOES.
+MatrizFloat matrizFloatEstatica(float * dados, int linhas, int colunas){
+    MatrizFloat matriz = {dados, linhas, colunas, passoMatriz(colunas, sizeof(float)), 1, 0, NULL, NULL, {NULL, 0, 0, 0, 1}};
+    return matriz;
+}
+
+//RETORNA UMA VISAO DO SUB-BLOCO [linha, linha+linhas) x [coluna, coluna+colunas), SEM COPIAR DADOS.
+//A dona DA VISAO E A MATRIZ QUE POSSUI OS DADOS (A dona DE matriz, SE ELA TAMBEM FOR UMA VISAO).
+MatrizFloat visaoMatrizFloat(const MatrizFloat * matriz, int linha, int coluna, int linhas, int colunas){
+    MatrizFloat visao = {NULL, 0, 0, 0, 1, 0, NULL, NULL, {NULL, 0, 0, 0, 1}};
+    if(matriz == NULL || matriz->dados == NULL || linha < 0 || coluna < 0 ||
+       linha + linhas > matriz->linhas || coluna + colunas > matriz->colunas){
+        controlPrint("visaoMatrizFloat(): sub-bloco fora da matriz.\n");
+        return visao;
+    }
+
+    visao.dados = &elementoMatriz(matriz, linha, coluna);
+    visao.linhas = linhas;
+    visao.colunas = colunas;
+    visao.passo = matriz->passo;
+    visao.dona = matriz->dona != NULL ? matriz->dona : (MatrizFloat *) matriz;
+    return visao;
+}
+
+Matriz32Bits visaoMatriz32Bits(const Matriz32Bits * matriz, int linha, int coluna, int linhas, int colunas){
+    Matriz32Bits visao = {NULL, 0, 0, 0, 1};
+    if(matriz == NULL || matriz->dados == NULL || linha < 0 || coluna < 0 ||
+       linha + linhas > matriz->linhas || coluna + colunas > matriz->colunas){
+        controlPrint("visaoMatriz32Bits(): sub-bloco fora da matriz.\n");
+        return visao;
+    }
+
+    visao.dados = &elementoMatriz(matriz, linha, coluna);
+    visao.linhas = linhas;
+    visao.colunas = colunas;
+    visao.passo = matriz->passo;
+    return visao;
+}
+
+Matriz16Bits visaoMatriz16Bits(const Matriz16Bits * matriz, int linha, int coluna, int linhas, int colunas){
+    Matriz16Bits visao = {NULL, 0, 0, 0, 1};
+    if(matriz == NULL || matriz->dados == NULL || linha < 0 || coluna < 0 ||
+       linha + linhas > matriz->linhas || coluna + colunas > matriz->colunas){
+        controlPrint("visaoMatriz16Bits(): sub-bloco fora da matriz.\n");
+        return visao;
+    }
+
+    visao.dados = &elementoMatriz(matriz, linha, coluna);
+    visao.linhas = linhas;
+    visao.colunas = colunas;
+    visao.passo = matriz->passo;
+    return visao;
+}
+
+//LIBERA O CACHE Q8.8 DE UMA MATRIZ FLOAT, SE EXISTIR E TIVER SIDO ALOCADO.
+static void destruirMatrizQuantizada(MatrizFloat * matriz){
+    if(matriz->quantizada == NULL)
+        return;
+    if(matriz->quantizada->valores != &matriz->quantizada->estatica){
+        destruirMatriz16Bits(matriz->quantizada->valores);
+        free(matriz->quantizada);
+    }
+    matriz->quantizada = NULL;
+}
+
+//DA A UMA MATRIZ ESTATICA UM CACHE Q8.8 SEM ALOCACAO, PARA QUE obterMatrizQuantizada NAO CHAME malloc. cache E dados
+//(DECLARADO COM DADOS_MATRIZ_Q88 COM AS DIMENSOES DA MATRIZ) DEVEM EXISTIR ENQUANTO ELA EXISTIR. VISOES NAO TEM CACHE.
+void cacheEstaticoMatrizFloat(MatrizFloat * matriz, MatrizQuantizada * cache, uint16_t * dados){
+    if(matriz == NULL || matriz->dona != NULL || cache == NULL || dados == NULL){
+        controlPrint("cacheEstaticoMatrizFloat(): matriz vazia ou visao.\n");
+        return;
+    }
+
+    destruirMatrizQuantizada(matriz);
+    cache->estatica.dados = dados;
+    cache->estatica.linhas = matriz->linhas;
+    cache->estatica.colunas = matriz->colunas;
+    cache->estatica.passo = passoMatriz(matriz->colunas, sizeof(uint16_t));
+    cache->estatica.visao = 1;
+    cache->valores = &cache->estatica;
+    cache->versao = matriz->versao - 1; //DESATUALIZADO ATE A PRIMEIRA CONVERSAO.
+    matriz->quantizada = cache;
+}
+
+//MATRIZES ESTATICAS NAO POSSUEM DADOS, MAS PODEM POSSUIR UM CACHE Q8.8, LIBERADO AQUI. VISOES NAO POSSUEM NENHUM DOS DOIS.
+void destruirMatrizFloat(MatrizFloat * matriz){
+    if(matriz == NULL)
+        return;
+    if(matriz->dona == NULL)
+        destruirMatrizQuantizada(matriz);
+    if(matriz->visao){
+        controlPrint("destruirMatrizFloat(): visoes nao possuem dados para liberar.\n");
+        return;
+    }
     controlPrint("Destruindo matriz float %u... ", matriz);
-    int i;
-    for(i = 0; i < tam; i++)
-        free(matriz[i]);
     free(matriz);
-    if(PRINT_ACTIVATED) controlPrint("Destruida!\n\n");
+    controlPrint("Destruida!\n\n");
 }
 
-void destruirMatriz32Bits(uint32_t ** matriz, int tam){
+void destruirMatriz32Bits(Matriz32Bits * matriz){
+    if(matriz == NULL || matriz->visao){
+        controlPrint("destruirMatriz32Bits(): visoes nao possuem dados para liberar.\n");
+        return;
+    }
     controlPrint("Destruindo matriz de 32 bits %u... ", matriz);
-    int i;
-    for(i = 0; i < tam; i++)
-        free(matriz[i]);
     free(matriz);
     controlPrint("Destruida!\n\n");
 }
 
-void instanciaMatrizAleatoriamente(float ** matriz, int tam){
-    if(matriz == NULL || *matriz == NULL){
+void destruirMatriz16Bits(Matriz16Bits * matriz){
+    if(matriz == NULL || matriz->visao){
+        controlPrint("destruirMatriz16Bits(): visoes nao possuem dados para liberar.\n");
+        return;
+    }
+    controlPrint("Destruindo matriz de 16 bits %u... ", matriz);
+    free(matriz);
+    controlPrint("Destruida!\n\n");
+}
+
+void destruirMatriz8Bits(Matriz8Bits * matriz){
+    if(matriz == NULL || matriz->visao){
+        controlPrint("destruirMatriz8Bits(): visoes nao possuem dados para liberar.\n");
+        return;
+    }
+    controlPrint("Destruindo matriz de 8 bits %u... ", matriz);
+    free(matriz);
+    controlPrint("Destruida!\n\n");
+}
+
+//CONVERTE TODOS OS ELEMENTOS DE UMA MATRIZ FLOAT PARA Q8.8, UMA UNICA VEZ POR ELEMENTO.
+void converteMatrizParaPontoFixo(const MatrizFloat * origem, Matriz16Bits * destino){
+    if(origem == NULL || origem->dados == NULL || destino == NULL || destino->dados == NULL){
+        controlPrint("converteMatrizParaPontoFixo(): matriz vazia.\n");
+        return;
+    }
+
+    if(origem->linhas != destino->linhas || origem->colunas != destino->colunas){
+        controlPrint("converteMatrizParaPontoFixo(): dimensoes incompativeis.\n");
+        return;
+    }
+
+    int i, j;
+    for(i = 0; i < origem->linhas; i++){
+        for(j = 0; j < origem->colunas; j++)
+            elementoMatriz(destino, i, j) = converteParaPontoFixo(elementoMatriz(origem, i, j));
+    }
+}
+
+//INVALIDA O CACHE Q8.8 APOS UMA ESCRITA DIRETA NOS DADOS DA MATRIZ. ESCREVER POR UMA VISAO ALTERA A dona.
+void marcarMatrizAlterada(MatrizFloat * matriz){
+    if(matriz == NULL)
+        return;
+    matriz->versao++;
+    if(matriz->dona != NULL)
+        matriz->dona->versao++;
+}
+
+//RETORNA A COPIA Q8.8 DA MATRIZ, CONVERTENDO-A APENAS SE AINDA NAO EXISTIR OU SE ESTIVER DESATUALIZADA.
+//ASSIM CADA ELEMENTO E CONVERTIDO UMA VEZ POR ALTERACAO, E NAO UMA VEZ POR PRODUTO ESCALAR. UMA VISAO NAO TEM
+//CACHE PROPRIO: RECEBE O SUB-BLOCO DO CACHE DA dona (QUE TODA ESCRITA POR UMA VISAO INVALIDA), GUARDADO EM
+//visaoQuantizada E VALIDO ENQUANTO A VISAO EXISTIR. ASSIM NADA E ALOCADO POR VISAO E NADA FICA SEM LIBERAR.
+const Matriz16Bits * obterMatrizQuantizada(const MatrizFloat * matriz){
+    if(matriz == NULL || matriz->dados == NULL){
+        controlPrint("obterMatrizQuantizada(): matriz vazia.\n");
+        return NULL;
+    }
+
+    MatrizFloat * origem = (MatrizFloat *) matriz; //O CACHE NAO FAZ PARTE DO VALOR LOGICO DA MATRIZ.
+    if(origem->dona != NULL){
+        const Matriz16Bits * cache = obterMatrizQuantizada(origem->dona);
+        if(cache == NULL)
+            return NULL;
+        int deslocamento = (int)(origem->dados - origem->dona->dados);
+        origem->visaoQuantizada = visaoMatriz16Bits(cache, deslocamento / origem->dona->passo, deslocamento % origem->dona->passo,
+                                                    origem->linhas, origem->colunas);
+        return &origem->visaoQuantizada;
+    }
+
+    MatrizQuantizada * quantizada = origem->quantizada;
+    if(quantizada == NULL){
+        quantizada = (MatrizQuantizada *) malloc(sizeof(MatrizQuantizada));
+        if(quantizada == NULL){
+            controlPrint("obterMatrizQuantizada(): erro ao alocar memoria para o cache.\n");
+            return NULL;
+        }
+        quantizada->valores = criarMatriz16Bits(origem->linhas, origem->colunas);
+        if(quantizada->valores == NULL){
+            free(quantizada);
+            return NULL;
+        }
+        origem->quantizada = quantizada;
+    }
+    else if(quantizada->versao == origem->versao){
+        return quantizada->valores;
+    }
+
+    converteMatrizParaPontoFixo(origem, quantizada->valores);
+    quantizada->versao = origem->versao;
+    return quantizada->valores;
+}
+
+void instanciaMatrizAleatoriamente(MatrizFloat * matriz){
+    if(matriz == NULL || matriz->dados == NULL){
         controlPrint("instanciaMatrizAleatoriamente(): matriz vazia.\n");
         return;
     }
@@ -91,15 +328,16 @@ void instanciaMatrizAleatoriamente(float ** matriz, int tam){
     controlPrint("Instanciando matriz %u...\n", matriz);
 
     int i, j;
-    for(i = 0; i < tam; i++){
-        for(j = 0; j < tam; j++)
-            matriz[i][j] = (i*j+1)%255 + 0.1241*i + 0.421*j + ((int)matriz%255)*0.527;
+    for(i = 0; i < matriz->linhas; i++){
+        for(j = 0; j < matriz->colunas; j++)
+            elementoMatriz(matriz, i, j) = (i*j+1)%255 + 0.1241*i + 0.421*j + ((int)matriz%255)*0.527;
     }   
+    marcarMatrizAlterada(matriz);
     controlPrint("Matriz %u instanciada!\n", matriz); 
 }
 
-void instanciaMatrizIdentidade(float ** matriz, int tam){
-    if(matriz == NULL || *matriz == NULL){
+void instanciaMatrizIdentidade(MatrizFloat * matriz){
+    if(matriz == NULL || matriz->dados == NULL){
         controlPrint("instanciaMatrizAleatoriamente(): matriz vazia.\n");
         return;
     }
@@ -107,17 +345,18 @@ void instanciaMatrizIdentidade(float ** matriz, int tam){
     controlPrint("Instanciando matriz %u...\n", matriz);
 
     int i, j;
-    for(i = 0; i < tam; i++){
-        for(j = 0; j < tam; j++){
-            if(i == j) matriz[i][j] = 1;
-            else matriz[i][j] = 0;
+    for(i = 0; i < matriz->linhas; i++){
+        for(j = 0; j < matriz->colunas; j++){
+            if(i == j) elementoMatriz(matriz, i, j) = 1;
+            else elementoMatriz(matriz, i, j) = 0;
         }
     }   
+    marcarMatrizAlterada(matriz);
     controlPrint("Matriz %u instanciada!\n", matriz); 
 }
 
-void instanciaMatrizUnitaria(float ** matriz, int tam){
-    if(matriz == NULL || *matriz == NULL){
+void instanciaMatrizUnitaria(MatrizFloat * matriz){
+    if(matriz == NULL || matriz->dados == NULL){
         controlPrint("instanciaMatrizAleatoriamente(): matriz vazia.\n");
         return;
     }
@@ -125,15 +364,16 @@ void instanciaMatrizUnitaria(float ** matriz, int tam){
     controlPrint("Instanciando matriz %u...\n", matriz);
 
     int i, j;
-    for(i = 0; i < tam; i++){
-        for(j = 0; j < tam; j++)
-            matriz[i][j] = 1;
+    for(i = 0; i < matriz->linhas; i++){
+        for(j = 0; j < matriz->colunas; j++)
+            elementoMatriz(matriz, i, j) = 1;
     }   
+    marcarMatrizAlterada(matriz);
     controlPrint("Matriz %u instanciada!\n", matriz); 
 }
 
-void imprimirMatrizFloat(float ** matriz, int tam){
-    if(matriz == NULL || *matriz == NULL){
+void imprimirMatrizFloat(const MatrizFloat * matriz){
+    if(matriz == NULL || matriz->dados == NULL){
         myPrint("imprimirMatrizFloat(): matriz vazia.\n");
         return;
     }
@@ -141,16 +381,16 @@ void imprimirMatrizFloat(float ** matriz, int tam){
     myPrint("Imprimindo matriz float %u...\n", matriz);
 
     int i, j;
-    for(i = 0; i < tam; i++){
-        for(j = 0; j < tam; j++)
-            print("", matriz[i][j]);
+    for(i = 0; i < matriz->linhas; i++){
+        for(j = 0; j < matriz->colunas; j++)
+            print("", elementoMatriz(matriz, i, j));
         myPrint("\n");
     }  
     myPrint("\n");
 }
 
-void imprimirMatriz32Bits(uint32_t ** matriz, int tam){
-    if(matriz == NULL || *matriz == NULL){
+void imprimirMatriz32Bits(const Matriz32Bits * matriz){
+    if(matriz == NULL || matriz->dados == NULL){
         myPrint("imprimirMatriz32Bits(): matriz vazia.\n");
         return;
     }
@@ -158,53 +398,295 @@ void imprimirMatriz32Bits(uint32_t ** matriz, int tam){
     myPrint("Imprimindo matriz de 32 bits %u...\n", matriz);
 
     int i, j;
-    for(i = 0; i < tam; i++){
-        for(j = 0; j < tam; j++)
-            myPrint("%u ", matriz[i][j]);
+    for(i = 0; i < matriz->linhas; i++){
+        for(j = 0; j < matriz->colunas; j++)
+            myPrint("%u ", elementoMatriz(matriz, i, j));
         myPrint("\n");
     }  
     myPrint("\n");
 }
 
-float ** multiplicarMatriz(float ** matrizA, float ** matrizB, int tam){
-    if(matrizA == NULL || *matrizA == NULL){
+MatrizFloat * multiplicarMatriz(const MatrizFloat * matrizA, const MatrizFloat * matrizB){
+    if(matrizA == NULL || matrizA->dados == NULL){
         controlPrint("multiplicarMatriz(): matriz A vazia.\n");
         return NULL;
     }
 
-    if(matrizB == NULL || *matrizB == NULL){
+    if(matrizB == NULL || matrizB->dados == NULL){
         controlPrint("multiplicarMatriz(): matriz B vazia.\n");
         return NULL;
     }
 
+    if(matrizA->colunas != matrizB->linhas){
+        controlPrint("multiplicarMatriz(): dimensoes incompativeis.\n");
+        return NULL;
+    }
+
     controlPrint("Iniciando multiplicacao das matrizes %u e %u em SOFTWARE...\n", matrizA, matrizB);
 
-    float ** matrizResultante = criarMatrizFloat(tam);
-    uint32_t ** matrizResultante32Bits = criarMatriz32Bits(tam);
+    const Matriz16Bits * matrizA16 = obterMatrizQuantizada(matrizA);
+    const Matriz16Bits * matrizB16 = obterMatrizQuantizada(matrizB);
+    if(matrizA16 == NULL || matrizB16 == NULL)
+        return NULL;
+
+    MatrizFloat * matrizResultante = criarMatrizFloat(matrizA->linhas, matrizB->colunas);
+    if(matrizResultante == NULL)
+        return NULL;
     
     int i, j, k;
-    uint16_t valorMatrizA, valorMatrizB;
+    uint32_t valorMatrizResultante32Bits;
 
-    for(i = 0; i < tam; i++){
-        for(j = 0; j < tam; j++){
-            matrizResultante[i][j] = 0.0;
+    for(i = 0; i < matrizA->linhas; i++){
+        for(j = 0; j < matrizB->colunas; j++){
+            valorMatrizResultante32Bits = 0;
             controlPrint("Multiplicando linha %d de A pela coluna %d de B...\n", i, j);
-            for(k = 0; k < tam; k++){
-                valorMatrizA = converteParaPontoFixo(matrizA[i][k]);
-                valorMatrizB = converteParaPontoFixo(matrizB[k][j]);
-                matrizResultante32Bits[i][j] += valorMatrizA * valorMatrizB;
-                matrizResultante[i][j] += matrizA[i][k]*matrizB[k][j];
+            for(k = 0; k < matrizA->colunas; k++)
+                valorMatrizResultante32Bits += (uint32_t) elementoMatriz(matrizA16, i, k) * elementoMatriz(matrizB16, k, j);
+            elementoMatriz(matrizResultante, i, j) = converteParaFloat(valorMatrizResultante32Bits);
+        }
+    }
+
+    return matrizResultante;
+}
+
+//BLOCOS Q8.8 DE A E B REORGANIZADOS PARA QUE O MICRO-KERNEL OS PERCORRA SEQUENCIALMENTE.
+static uint16_t pacoteA[BLOCO_M * BLOCO_K];
+static uint16_t pacoteB[BLOCO_K * BLOCO_N];
+
+//COPIA O BLOCO mc x kc DE A EM FATIAS DE MICRO_BLOCO LINHAS, COM AS LINHAS DE CADA FATIA INTERCALADAS POR k.
+static void empacotaBlocoA(const Matriz16Bits * matrizA, int linha0, int k0, int mc, int kc){
+    uint16_t * destino = pacoteA;
+    int i, ii, k;
+    for(i = 0; i < mc; i += MICRO_BLOCO){
+        for(k = 0; k < kc; k++){
+            for(ii = 0; ii < MICRO_BLOCO; ii++)
+                *destino++ = (i + ii < mc) ? elementoMatriz(matrizA, linha0 + i + ii, k0 + k) : 0;
+        }
+    }
+}
+
+//COPIA O BLOCO kc x nc DE B EM FATIAS DE MICRO_BLOCO COLUNAS, COM AS COLUNAS DE CADA FATIA INTERCALADAS POR k.
+static void empacotaBlocoB(const Matriz16Bits * matrizB, int k0, int coluna0, int kc, int nc){
+    uint16_t * destino = pacoteB;
+    int j, jj, k;
+    for(j = 0; j < nc; j += MICRO_BLOCO){
+        for(k = 0; k < kc; k++){
+            for(jj = 0; jj < MICRO_BLOCO; jj++)
+                *destino++ = (j + jj < nc) ? elementoMatriz(matrizB, k0 + k, coluna0 + j + jj) : 0;
+        }
+    }
+}
+
+//ACUMULA EM SOMAS[i..i+mr) x [j..j+nr) O PRODUTO DE UMA FATIA DE A POR UMA FATIA DE B, COM OS 4x4 PARCIAIS Q16.16
+//EM REGISTRADORES (MODULO 2^32, COMO multiplicarMatriz).
+static void microKernel(int kc, const uint16_t * a, const uint16_t * b, Matriz32Bits * somas, int i, int j, int mr, int nr){
+    uint32_t c00 = 0, c01 = 0, c02 = 0, c03 = 0;
+    uint32_t c10 = 0, c11 = 0, c12 = 0, c13 = 0;
+    uint32_t c20 = 0, c21 = 0, c22 = 0, c23 = 0;
+    uint32_t c30 = 0, c31 = 0, c32 = 0, c33 = 0;
+
+    int k;
+    for(k = 0; k < kc; k++){
+        uint32_t a0 = a[0], a1 = a[1], a2 = a[2], a3 = a[3];
+        uint32_t b0 = b[0], b1 = b[1], b2 = b[2], b3 = b[3];
+
+        c00 += a0*b0; c01 += a0*b1; c02 += a0*b2; c03 += a0*b3;
+        c10 += a1*b0; c11 += a1*b1; c12 += a1*b2; c13 += a1*b3;
+        c20 += a2*b0; c21 += a2*b1; c22 += a2*b2; c23 += a2*b3;
+        c30 += a3*b0; c31 += a3*b1; c32 += a3*b2; c33 += a3*b3;
+
+        a += MICRO_BLOCO;
+        b += MICRO_BLOCO;
+    }
+
+    uint32_t parcial[MICRO_BLOCO][MICRO_BLOCO] = {
+        {c00, c01, c02, c03},
+        {c10, c11, c12, c13},
+        {c20, c21, c22, c23},
+        {c30, c31, c32, c33}
+    };
+
+    int ii, jj;
+    for(ii = 0; ii < mr; ii++){
+        for(jj = 0; jj < nr; jj++)
+            elementoMatriz(somas, i + ii, j + jj) += parcial[ii][jj];
+    }
+}
+
+//MESMA ARITMETICA DE multiplicarMatriz (COPIAS Q8.8 EM CACHE, SOMAS Q16.16 MODULO 2^32 E UMA CONVERSAO PARA FLOAT
+//POR ELEMENTO), ENTAO O RESULTADO E IDENTICO; SO A ORDEM DOS ACESSOS MUDA. AS SOMAS FICAM NO PROPRIO BUFFER DE C,
+//QUE TEM O MESMO TAMANHO E PASSO, ATE A CONVERSAO FINAL.
+MatrizFloat * multiplicarMatrizBlocada(const MatrizFloat * matrizA, const MatrizFloat * matrizB){
+    if(matrizA == NULL || matrizA->dados == NULL){
+        controlPrint("multiplicarMatrizBlocada(): matriz A vazia.\n");
+        return NULL;
+    }
+
+    if(matrizB == NULL || matrizB->dados == NULL){
+        controlPrint("multiplicarMatrizBlocada(): matriz B vazia.\n");
+        return NULL;
+    }
+
+    if(matrizA->colunas != matrizB->linhas){
+        controlPrint("multiplicarMatrizBlocada(): dimensoes incompativeis.\n");
+        return NULL;
+    }
+
+    controlPrint("Iniciando multiplicacao BLOCADA das matrizes %u e %u em SOFTWARE...\n", matrizA, matrizB);
+
+    const Matriz16Bits * matrizA16 = obterMatrizQuantizada(matrizA);
+    const Matriz16Bits * matrizB16 = obterMatrizQuantizada(matrizB);
+    if(matrizA16 == NULL || matrizB16 == NULL)
+        return NULL;
+
+    int m = matrizA->linhas, n = matrizB->colunas, tamK = matrizA->colunas;
+    MatrizFloat * matrizResultante = criarMatrizFloat(m, n);
+    if(matrizResultante == NULL)
+        return NULL;
+
+    Matriz32Bits somas = {(uint32_t *) matrizResultante->dados, m, n, matrizResultante->passo, 1};
+    int i, j;
+    for(i = 0; i < m; i++){
+        for(j = 0; j < n; j++)
+            elementoMatriz(&somas, i, j) = 0;
+    }
+
+    int i0, j0, k0;
+    for(j0 = 0; j0 < n; j0 += BLOCO_N){
+        int nc = (n - j0 < BLOCO_N) ? n - j0 : BLOCO_N;
+        for(k0 = 0; k0 < tamK; k0 += BLOCO_K){
+            int kc = (tamK - k0 < BLOCO_K) ? tamK - k0 : BLOCO_K;
+            empacotaBlocoB(matrizB16, k0, j0, kc, nc);
+
+            for(i0 = 0; i0 < m; i0 += BLOCO_M){
+                int mc = (m - i0 < BLOCO_M) ? m - i0 : BLOCO_M;
+                empacotaBlocoA(matrizA16, i0, k0, mc, kc);
+
+                for(j = 0; j < nc; j += MICRO_BLOCO){
+                    int nr = (nc - j < MICRO_BLOCO) ? nc - j : MICRO_BLOCO;
+                    for(i = 0; i < mc; i += MICRO_BLOCO){
+                        int mr = (mc - i < MICRO_BLOCO) ? mc - i : MICRO_BLOCO;
+                        microKernel(kc, &pacoteA[i * kc], &pacoteB[j * kc], &somas, i0 + i, j0 + j, mr, nr);
+                    }
+                }
             }
         }
     }
 
-    for(i = 0; i < tam; i++){
-        for(j = 0; j < tam; j++){
-            float valorMatrizResultante = converteParaFloat(matrizResultante32Bits[i][j]);
-            matrizResultante[i][j] = valorMatrizResultante;
+    for(i = 0; i < m; i++){
+        for(j = 0; j < n; j++)
+            elementoMatriz(matrizResultante, i, j) = converteParaFloat(elementoMatriz(&somas, i, j));
+    }
+
+    return matrizResultante;
+}
+
+//MULTIPLICA DUAS MATRIZES Q8.8 USANDO APENAS ARITMETICA INTEIRA (RV32M) NO LACO INTERNO.
+//CADA PRODUTO 16x16 E SOMADO MODULO 2^32 EM Q16.16, COMO FAZ O SOMADOR DO CFS, E CONVERTIDO
+//PARA FLOAT UMA UNICA VEZ POR ELEMENTO. O RESULTADO E IDENTICO, BIT A BIT, AO DE
+//multiplicaHardwarePontoFixo, SERVINDO COMO REFERENCIA PARA O ACELERADOR.
+MatrizFloat * multiplicarMatrizPontoFixo(const Matriz16Bits * matrizA, const Matriz16Bits * matrizB){
+    if(matrizA == NULL || matrizA->dados == NULL){
+        controlPrint("multiplicarMatrizPontoFixo(): matriz A vazia.\n");
+        return NULL;
+    }
+
+    if(matrizB == NULL || matrizB->dados == NULL){
+        controlPrint("multiplicarMatrizPontoFixo(): matriz B vazia.\n");
+        return NULL;
+    }
+
+    if(matrizA->colunas != matrizB->linhas){
+        controlPrint("multiplicarMatrizPontoFixo(): dimensoes incompativeis.\n");
+        return NULL;
+    }
+
+    controlPrint("Iniciando multiplicacao em PONTO FIXO das matrizes %u e %u em SOFTWARE...\n", matrizA, matrizB);
+
+    int m = matrizA->linhas, n = matrizB->colunas, tamK = matrizA->colunas;
+    MatrizFloat * matrizResultante = criarMatrizFloat(m, n);
+    Matriz32Bits * acumuladores = criarMatriz32Bits(1, n);
+    if(matrizResultante == NULL || acumuladores == NULL){
+        destruirMatrizFloat(matrizResultante);
+        destruirMatriz32Bits(acumuladores);
+        return NULL;
+    }
+
+    uint32_t * soma = acumuladores->dados;
+    int i, j, k;
+    for(i = 0; i < m; i++){
+        for(j = 0; j < n; j++)
+            soma[j] = 0;
+
+        //ORDEM i-k-j: A LINHA k DE B E PERCORRIDA DE FORMA CONTIGUA.
+        for(k = 0; k < tamK; k++){
+            uint32_t valorA = elementoMatriz(matrizA, i, k);
+            if(valorA == 0)
+                continue;
+
+            const uint16_t * linhaB = &elementoMatriz(matrizB, k, 0);
+            for(j = 0; j < n; j++)
+                soma[j] += valorA * linhaB[j];
+        }
+
+        for(j = 0; j < n; j++)
+            elementoMatriz(matrizResultante, i, j) = converteParaFloat(soma[j]);
+    }
+
+    destruirMatriz32Bits(acumuladores);
+    return matrizResultante;
+}
+
+//REFERENCIA EM SOFTWARE DO MODO INT8 DO CFS: SOMAS INT32 (MODULO 2^32) DOS PRODUTOS COM SINAL,
+//MULTIPLICADAS UMA UNICA VEZ PELAS ESCALAS DE A E B.
+MatrizFloat * multiplicarMatrizInt8(const Matriz8Bits * matrizA, const Matriz8Bits * matrizB){
+    if(matrizA == NULL || matrizA->dados == NULL){
+        controlPrint("multiplicarMatrizInt8(): matriz A vazia.\n");
+        return NULL;
+    }
+
+    if(matrizB == NULL || matrizB->dados == NULL){
+        controlPrint("multiplicarMatrizInt8(): matriz B vazia.\n");
+        return NULL;
+    }
+
+    if(matrizA->colunas != matrizB->linhas){
+        controlPrint("multiplicarMatrizInt8(): dimensoes incompativeis.\n");
+        return NULL;
+    }
+
+    controlPrint("Iniciando multiplicacao em INT8 das matrizes %u e %u em SOFTWARE...\n", matrizA, matrizB);
+
+    int m = matrizA->linhas, n = matrizB->colunas, tamK = matrizA->colunas;
+    MatrizFloat * matrizResultante = criarMatrizFloat(m, n);
+    Matriz32Bits * acumuladores = criarMatriz32Bits(1, n);
+    if(matrizResultante == NULL || acumuladores == NULL){
+        destruirMatrizFloat(matrizResultante);
+        destruirMatriz32Bits(acumuladores);
+        return NULL;
+    }
+
+    float escala = matrizA->escala * matrizB->escala;
+    uint32_t * soma = acumuladores->dados;
+    int i, j, k;
+    for(i = 0; i < m; i++){
+        for(j = 0; j < n; j++)
+            soma[j] = 0;
+
+        for(k = 0; k < tamK; k++){
+            int32_t valorA = elementoMatriz(matrizA, i, k);
+            if(valorA == 0)
+                continue;
+
+            const int8_t * linhaB = &elementoMatriz(matrizB, k, 0);
+            for(j = 0; j < n; j++)
+                soma[j] += (uint32_t)(valorA * linhaB[j]);
         }
+
+        for(j = 0; j < n; j++)
+            elementoMatriz(matrizResultante, i, j) = escala * (float)(int32_t)soma[j];
     }
 
-    destruirMatriz32Bits(matrizResultante32Bits, tam);
+    destruirMatriz32Bits(acumuladores);
     return matrizResultante;
-}
\ No newline at end of file
+}
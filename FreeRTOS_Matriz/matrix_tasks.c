@@ -37,20 +37,86 @@
 #include "matrix.h"
 #include "pontoflutuante.h"
 
+//ESCALONAMENTO: UM CONJUNTO FIXO DE NUM_TRABALHADORES TAREFAS RETIRA DE UMA FILA BLOCOS DE TAM_BLOCO x TAM_BLOCO
+//ELEMENTOS DE C E CALCULA CADA BLOCO INTEIRO. COM TAREFA_POR_ELEMENTO = 1, VOLTA O PROJETO ANTERIOR (UMA TAREFA
+//CRIADA POR ELEMENTO DE C), PARA COMPARAR AS TROCAS DE CONTEXTO, O HEAP E O TEMPO.
+#ifndef TAREFA_POR_ELEMENTO
+#define TAREFA_POR_ELEMENTO 0
+#endif
+#ifndef NUM_TRABALHADORES
+#define NUM_TRABALHADORES 4
+#endif
+#ifndef TAM_BLOCO
+#define TAM_BLOCO 4
+#endif
+#define BLOCOS_POR_LADO ((MAX_MATRIX + TAM_BLOCO - 1) / TAM_BLOCO)
+
+MatrizFloat * matrix1, * matrix2, * matrix3;
+
+#if TAREFA_POR_ELEMENTO
 typedef struct{
     uint32_t linha;
     uint32_t coluna;
 } TaskArgs;
 
-float ** matrix1, ** matrix2, ** matrix3;
-int liberaPrint = 0;
-
 TaskArgs args[MAX_MATRIX*MAX_MATRIX];
 
-int8_t mutex = 0;
+//CADA TAREFA AVISA A TAREFA DE IMPRESSAO (NOTIFICACAO) QUANDO TERMINA O SEU ELEMENTO.
+#define TAREFAS_A_AGUARDAR (MAX_MATRIX * MAX_MATRIX)
+#else
+//FILA DE BLOCOS DE C (INDICE LINHA * BLOCOS_POR_LADO + COLUNA).
+static QueueHandle_t filaBlocos;
+
+//CADA TRABALHADOR AVISA A TAREFA DE IMPRESSAO (NOTIFICACAO) QUANDO A FILA ESVAZIA.
+#define TAREFAS_A_AGUARDAR NUM_TRABALHADORES
+#endif
+
+//BLOQUEADA ATE RECEBER TAREFAS_A_AGUARDAR NOTIFICACOES, SEM GASTAR CPU: O TEMPO OCIOSO VAI PARA O SLEEP DA
+//vApplicationIdleHook.
+static TaskHandle_t tarefaImpressao;
+
+//A TAREFA verificaCFS MULTIPLICA AS MESMAS MATRIZES NO CFS (multiplica_hardware): AS LINHAS DE A VAO PELO DMA E, COM
+//CFS_IRQ_ATIVADA, ELA FICA BLOQUEADA EM aguardaCFS() (main.c) ATE A INTERRUPCAO DO FIM DO PRODUTO. A TAREFA DE IMPRESSAO
+//SO A CRIA DEPOIS DE MEDIR O TEMPO, AS TROCAS DE CONTEXTO E O HEAP DO CALCULO EM SOFTWARE, QUE ASSIM NAO INCLUEM O CFS.
+//AO TERMINAR, verificaCFS AVISA A TAREFA DE IMPRESSAO NO INDICE NOTIFICACAO_CFS (O INDICE 1 E O DO DRIVER), QUE
+//CONFERE matrixHardware COM O RESULTADO DO SOFTWARE.
+#define NOTIFICACAO_CFS 2
+
+//verificaCFS PASSA PELO DRIVER DO CFS (E, SEM ALOCACAO_ESTATICA, PELO malloc DELE), ENTAO TEM O DOBRO DA PILHA MINIMA.
+#define PILHA_CFS (2 * configMINIMAL_STACK_SIZE)
+MatrizFloat * matrixHardware;
+static int erroCFS = 0;
+
+#if ALOCACAO_ESTATICA
+//POOLS ESTATICOS (configSUPPORT_STATIC_ALLOCATION): UMA TCB E UMA PILHA POR TAREFA (AS AGUARDADAS E A DE IMPRESSAO),
+//A FILA DE BLOCOS, AS QUATRO MATRIZES E OS CACHES Q8.8 DAS DUAS QUE VAO PARA O CFS. verificaCFS TEM A SUA PROPRIA
+//PILHA (VER criaVerificaCFS) E O DRIVER DO CFS USA O SEU RASCUNHO ESTATICO (pontoflutuante.c): NADA E ALOCADO DURANTE A
+//EXECUCAO, E SEM O HEAP (configSUPPORT_DYNAMIC_ALLOCATION = 0) UM pvPortMalloc ESQUECIDO NEM CHEGA A SER LIGADO.
+#define NUM_TAREFAS (TAREFAS_A_AGUARDAR + 1)
+static StaticTask_t tcbTarefas[NUM_TAREFAS];
+static StackType_t pilhaTarefas[NUM_TAREFAS][configMINIMAL_STACK_SIZE];
+static uint32_t tarefasCriadas = 0;
+
+#if !TAREFA_POR_ELEMENTO
+static StaticQueue_t estruturaFilaBlocos;
+static uint8_t itensFilaBlocos[BLOCOS_POR_LADO * BLOCOS_POR_LADO * sizeof(uint32_t)];
+#endif
+
+static DADOS_MATRIZ_FLOAT(dados1, MAX_MATRIX, MAX_MATRIX);
+static DADOS_MATRIZ_FLOAT(dados2, MAX_MATRIX, MAX_MATRIX);
+static DADOS_MATRIZ_FLOAT(dados3, MAX_MATRIX, MAX_MATRIX);
+static DADOS_MATRIZ_FLOAT(dados4, MAX_MATRIX, MAX_MATRIX);
+static MatrizFloat estatica1, estatica2, estatica3, estatica4;
+static DADOS_MATRIZ_Q88(q88_1, MAX_MATRIX, MAX_MATRIX);
+static DADOS_MATRIZ_Q88(q88_2, MAX_MATRIX, MAX_MATRIX);
+static MatrizQuantizada cache1, cache2;
+#endif
 
 uint64_t t_inicio, t_fim;
 
+//TROCAS DE CONTEXTO, CONTADAS POR traceTASK_SWITCHED_IN (FreeRTOSConfig.h).
+volatile uint32_t trocasContexto = 0;
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -62,34 +128,72 @@ void matrix_tasks( void );
 /**
  * The tasks as described in the comments at the top of this file.
  */
+static void criaTarefa(TaskFunction_t funcao, const char * nome, void * parametro, UBaseType_t prioridade, TaskHandle_t * tarefa);
 static void imprimeMatrizResultante(void * sacanagem);
+static void verificaCFS(void * naoUsado);
+static void criaVerificaCFS(UBaseType_t prioridade);
+#if TAREFA_POR_ELEMENTO
 static void multiplicaLinhaColuna(void * args);
+#else
+static void multiplicaBlocos(void * naoUsado);
+#endif
 
 void matrix_tasks(void) {
-    matrix1 = criarMatrizFloat(MAX_MATRIX);
-    instanciaMatrizUnitaria(matrix1, MAX_MATRIX );
-    imprimirMatrizFloat(matrix1, MAX_MATRIX);
+#if ALOCACAO_ESTATICA
+    estatica1 = matrizFloatEstatica(dados1, MAX_MATRIX, MAX_MATRIX);
+    estatica2 = matrizFloatEstatica(dados2, MAX_MATRIX, MAX_MATRIX);
+    estatica3 = matrizFloatEstatica(dados3, MAX_MATRIX, MAX_MATRIX);
+    estatica4 = matrizFloatEstatica(dados4, MAX_MATRIX, MAX_MATRIX);
+    cacheEstaticoMatrizFloat(&estatica1, &cache1, q88_1); //multiplica_hardware SEM CFS_FLOAT_ATIVADO OU NA SISTOLICA.
+    cacheEstaticoMatrizFloat(&estatica2, &cache2, q88_2);
+    matrix1 = &estatica1;
+    matrix2 = &estatica2;
+    matrix3 = &estatica3;
+    matrixHardware = &estatica4;
+#else
+    matrix1 = criarMatrizFloat(MAX_MATRIX, MAX_MATRIX);
+    matrix2 = criarMatrizFloat(MAX_MATRIX, MAX_MATRIX);
+    matrix3 = criarMatrizFloat(MAX_MATRIX, MAX_MATRIX);
+    matrixHardware = criarMatrizFloat(MAX_MATRIX, MAX_MATRIX);
+#endif
+    instanciaMatrizUnitaria(matrix1);
+    imprimirMatrizFloat(matrix1);
     
-    matrix2 = criarMatrizFloat(MAX_MATRIX);
-    instanciaMatrizIdentidade(matrix2, MAX_MATRIX);
-    imprimirMatrizFloat(matrix2, MAX_MATRIX);
+    instanciaMatrizIdentidade(matrix2);
+    imprimirMatrizFloat(matrix2);
 
-    matrix3 = criarMatrizFloat(MAX_MATRIX);
     for (uint32_t i = 0; i < MAX_MATRIX; i++) {
         for (uint32_t j = 0; j < MAX_MATRIX; j++) {
-            matrix3[i][j] = 0;
+            elementoMatriz(matrix3, i, j) = 0;
         }
     }
     
 
+#if TAREFA_POR_ELEMENTO
     for(uint32_t i = 0; i < MAX_MATRIX; i++){
         for(uint32_t j = 0; j < MAX_MATRIX; j++){
             args[(i*MAX_MATRIX) + j].linha = i;
             args[(i*MAX_MATRIX) + j].coluna = j;
-            xTaskCreate(multiplicaLinhaColuna, "Linha x Coluna", configMINIMAL_STACK_SIZE, &args[(i*MAX_MATRIX)+j], 0, NULL);
+            criaTarefa(multiplicaLinhaColuna, "Linha x Coluna", &args[(i*MAX_MATRIX)+j], 0, NULL);
         }
     }
-    xTaskCreate(imprimeMatrizResultante, "Print Resultado", configMINIMAL_STACK_SIZE, NULL, 0, NULL);
+    criaTarefa(imprimeMatrizResultante, "Print Resultado", NULL, 0, &tarefaImpressao);
+#else
+    //TODOS OS BLOCOS SAO ENFILEIRADOS ANTES DE O ESCALONADOR COMECAR; UM TRABALHADOR TERMINA QUANDO A FILA ESVAZIA.
+    //ACIMA DA PRIORIDADE DA TAREFA OCIOSA, QUE DORME ATE A PROXIMA INTERRUPCAO E ATRASARIA O RODIZIO.
+#if ALOCACAO_ESTATICA
+    filaBlocos = xQueueCreateStatic(BLOCOS_POR_LADO * BLOCOS_POR_LADO, sizeof(uint32_t), itensFilaBlocos, &estruturaFilaBlocos);
+#else
+    filaBlocos = xQueueCreate(BLOCOS_POR_LADO * BLOCOS_POR_LADO, sizeof(uint32_t));
+#endif
+    if(filaBlocos != NULL) {
+        for(uint32_t bloco = 0; bloco < BLOCOS_POR_LADO * BLOCOS_POR_LADO; bloco++)
+            xQueueSend(filaBlocos, &bloco, 0);
+        criaTarefa(imprimeMatrizResultante, "Print Resultado", NULL, tskIDLE_PRIORITY + 1, &tarefaImpressao);
+        for(uint32_t n = 0; n < NUM_TRABALHADORES; n++)
+            criaTarefa(multiplicaBlocos, "Blocos de C", NULL, tskIDLE_PRIORITY + 1, NULL);
+    }
+#endif
     t_inicio = neorv32_mtime_get_time();
     vTaskStartScheduler();
 
@@ -98,28 +202,116 @@ void matrix_tasks(void) {
     };
 }
 
+//CRIA UMA TAREFA COM PILHA DE configMINIMAL_STACK_SIZE PALAVRAS, COM A TCB E A PILHA DO POOL ESTATICO OU DO HEAP.
+static void criaTarefa(TaskFunction_t funcao, const char * nome, void * parametro, UBaseType_t prioridade, TaskHandle_t * tarefa){
+#if ALOCACAO_ESTATICA
+    TaskHandle_t criada = NULL;
+    if(tarefasCriadas < NUM_TAREFAS) {
+        criada = xTaskCreateStatic(funcao, nome, configMINIMAL_STACK_SIZE, parametro, prioridade,
+                                   pilhaTarefas[tarefasCriadas], &tcbTarefas[tarefasCriadas]);
+        tarefasCriadas++;
+    }
+    if(tarefa != NULL)
+        *tarefa = criada;
+#else
+    xTaskCreate(funcao, nome, configMINIMAL_STACK_SIZE, parametro, prioridade, tarefa);
+#endif
+}
+
+//CRIA A TAREFA verificaCFS COM PILHA_CFS PALAVRAS, ESTATICA OU DO HEAP COMO criaTarefa.
+static void criaVerificaCFS(UBaseType_t prioridade){
+#if ALOCACAO_ESTATICA
+    static StaticTask_t tcbCFS;
+    static StackType_t pilhaCFS[PILHA_CFS];
+    xTaskCreateStatic(verificaCFS, "Verifica CFS", PILHA_CFS, NULL, prioridade, pilhaCFS, &tcbCFS);
+#else
+    xTaskCreate(verificaCFS, "Verifica CFS", PILHA_CFS, NULL, prioridade, NULL);
+#endif
+}
+
+#if TAREFA_POR_ELEMENTO
 static void multiplicaLinhaColuna(void * args){
     uint32_t linha = ((TaskArgs*)args)->linha;
     uint32_t coluna = ((TaskArgs*)args)->coluna;
 
     for(uint32_t k = 0; k < MAX_MATRIX; k++) {
-        matrix3[linha][coluna] += matrix1[linha][k] * matrix2[k][coluna];
+        elementoMatriz(matrix3, linha, coluna) += elementoMatriz(matrix1, linha, k) * elementoMatriz(matrix2, k, coluna);
+    }
+
+    xTaskNotifyGive(tarefaImpressao);
+    vTaskDelete(NULL);
+}
+#else
+//TRABALHADOR: CALCULA BLOCOS DE C ATE A FILA ESVAZIAR, AVISA A TAREFA DE IMPRESSAO E TERMINA.
+static void multiplicaBlocos(void * naoUsado){
+    (void) naoUsado;
+    uint32_t bloco;
+
+    while(xQueueReceive(filaBlocos, &bloco, 0) == pdPASS) {
+        uint32_t linha0 = (bloco / BLOCOS_POR_LADO) * TAM_BLOCO;
+        uint32_t coluna0 = (bloco % BLOCOS_POR_LADO) * TAM_BLOCO;
+        uint32_t linha1 = (linha0 + TAM_BLOCO < MAX_MATRIX) ? linha0 + TAM_BLOCO : MAX_MATRIX;
+        uint32_t coluna1 = (coluna0 + TAM_BLOCO < MAX_MATRIX) ? coluna0 + TAM_BLOCO : MAX_MATRIX;
+        for(uint32_t linha = linha0; linha < linha1; linha++) {
+            for(uint32_t coluna = coluna0; coluna < coluna1; coluna++) {
+                float soma = 0;
+                for(uint32_t k = 0; k < MAX_MATRIX; k++) {
+                    soma += elementoMatriz(matrix1, linha, k) * elementoMatriz(matrix2, k, coluna);
+                }
+                elementoMatriz(matrix3, linha, coluna) = soma;
+            }
+        }
     }
 
-    //região crítica...
-    while (mutex);
-    mutex = 1;
-        liberaPrint++;
-    mutex = 0;
+    xTaskNotifyGive(tarefaImpressao);
+    vTaskDelete(NULL);
+}
+#endif
 
+//MULTIPLICA matrix1 x matrix2 NO CFS, EM matrixHardware, E AVISA A TAREFA DE IMPRESSAO.
+static void verificaCFS(void * naoUsado){
+    (void) naoUsado;
+    erroCFS = multiplica_hardware(matrix1, matrix2, matrixHardware);
+    xTaskNotifyGiveIndexed(tarefaImpressao, NOTIFICACAO_CFS);
     vTaskDelete(NULL);
 }
 
 static void imprimeMatrizResultante(void * sacanagem){
     (void) sacanagem;
-    while(liberaPrint < MAX_MATRIX * MAX_MATRIX);
+    for(uint32_t n = 0; n < TAREFAS_A_AGUARDAR; n++)
+        ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
     t_fim = neorv32_mtime_get_time();
-    imprimirMatrizFloat(matrix3, MAX_MATRIX);
+    uint32_t trocas = trocasContexto;
+#if !ALOCACAO_ESTATICA
+    uint32_t heapUsado = (uint32_t)(configTOTAL_HEAP_SIZE - xPortGetMinimumEverFreeHeapSize());
+#endif
+    criaVerificaCFS(uxTaskPriorityGet(NULL)); //SO DEPOIS DAS MEDIDAS DO CALCULO EM SOFTWARE.
+    imprimirMatrizFloat(matrix3);
     longPrint("TEMPO HARDWARE: ", ((double)(t_fim - t_inicio))/50000000);
+#if TAREFA_POR_ELEMENTO
+    myPrint("\nESCALONAMENTO: %u TAREFAS, UMA POR ELEMENTO\n", MAX_MATRIX * MAX_MATRIX);
+#else
+    myPrint("\nESCALONAMENTO: %u TRABALHADORES, BLOCOS DE %ux%u\n", NUM_TRABALHADORES, TAM_BLOCO, TAM_BLOCO);
+#endif
+    myPrint("TROCAS DE CONTEXTO: %u\n", trocas);
+#if ALOCACAO_ESTATICA
+    myPrint("ALOCACAO ESTATICA: %u TAREFAS DO POOL, SEM HEAP\n", tarefasCriadas);
+#else
+    myPrint("HEAP USADO (PICO): %u de %u bytes\n", heapUsado, (uint32_t)configTOTAL_HEAP_SIZE);
+#endif
+
+    //AS MATRIZES (UNITARIA x IDENTIDADE) SAO EXATAS EM Q8.8, ENTAO O CFS DEVE REPRODUZIR O RESULTADO DO SOFTWARE.
+    ulTaskNotifyTakeIndexed(NOTIFICACAO_CFS, pdTRUE, portMAX_DELAY);
+    if(erroCFS)
+        myPrint("CFS: produto recusado pelo driver (erro %d)\n", erroCFS);
+    else {
+        uint32_t divergencias = 0;
+        for(uint32_t i = 0; i < MAX_MATRIX; i++) {
+            for(uint32_t j = 0; j < MAX_MATRIX; j++) {
+                if(elementoMatriz(matrixHardware, i, j) != elementoMatriz(matrix3, i, j)) divergencias++;
+            }
+        }
+        myPrint("CFS: %u divergencias\n", divergencias);
+    }
     vTaskDelete(NULL);
-}
\ No newline at end of file
+}
@@ -25,30 +25,80 @@
 #include "pontoflutuante.h"
 #include "matrix.h"
 
+//ACESSO AOS BITS IEEE-754 DE UM FLOAT.
+typedef union {
+    float valor;
+    uint32_t bits;
+} FloatBits;
+
+#define FLOAT_EXPOENTE_DESLOC 23
+#define FLOAT_MANTISSA_MASCARA 0x007FFFFF
+#define FLOAT_BIT_IMPLICITO 0x00800000
+#define FLOAT_VIES 127
+
 //CONVERTE UM NÚMERO REAL FLOAT PARA UM NÚMERO BINÁRIO DE 16 BITS.
+//OPERA DIRETO NOS BITS: num * 2^8 = mantissa * 2^(expoente - 15), LOGO BASTA DESLOCAR A MANTISSA
+//(COM O BIT IMPLICITO) 15 - expoente POSICOES PARA A DIREITA. VALIDO PARA 0 <= num < 256;
+//ZERO, SUBNORMAIS E NEGATIVOS RESULTAM EM 0.
 uint16_t converteParaPontoFixo(float num){
+    FloatBits f;
+    f.valor = num;
+
+    int32_t expoente = (int32_t)((f.bits >> FLOAT_EXPOENTE_DESLOC) & 0xFF) - FLOAT_VIES;
+    uint32_t mantissa = (f.bits & FLOAT_MANTISSA_MASCARA) | FLOAT_BIT_IMPLICITO;
+    uint32_t deslocamento = (uint32_t)(15 - expoente);
+
+    uint32_t mascaraValido = -(uint32_t)(deslocamento < 32);  //0 QUANDO num < 2^-16 OU num >= 2^16
+    uint32_t mascaraPositivo = (f.bits >> 31) - 1;              //0 QUANDO num E NEGATIVO
+
+    return (uint16_t)((mantissa >> (deslocamento & 31)) & mascaraValido & mascaraPositivo);
+}
+
+//CONVERTE UM NÚMERO BINÁRIO DE 32 BITS PARA UM NÚMERO REAL.
+//num / 2^16: CONVERTE O INTEIRO PARA FLOAT (ARREDONDADO UMA UNICA VEZ, COMO NA SOMA ORIGINAL)
+//E SUBTRAI 16 DO EXPOENTE, O QUE E EXATO PARA QUALQUER num != 0.
+float converteParaFloat(uint32_t num){
+    FloatBits f;
+    f.valor = (float) num;
+    f.bits -= (16u << FLOAT_EXPOENTE_DESLOC) & -(uint32_t)(num != 0);
+    return f.valor;
+}
+
+//CONVERTE A PARTE FRACIONÁRIA DE UM NÚMERO PARA UM BINÁRIO DE 8 BITS.
+//PARA 0 <= flutuante < 1 E O BYTE MENOS SIGNIFICATIVO DO VALOR Q8.8.
+uint8_t flutuanteParaBinario(float flutuante){
+    return (uint8_t) converteParaPontoFixo(flutuante);
+}
+
+//CONVERTE UM NÚMERO BINÁRIO DE 16 BITS PARA A PARTE FLUTUANTE DE UM NÚMERO REAL.
+float binarioParaFlutuante(uint16_t flutuante){
+    return converteParaFloat(flutuante);
+}
+
+//VERSAO ITERATIVA (ORIGINAL) DE converteParaPontoFixo, MANTIDA COMO REFERENCIA.
+uint16_t converteParaPontoFixoIterativo(float num){
     uint8_t inteiro8bits = (uint8_t)num;
     float flutuante = num - (float) inteiro8bits;
     
-    uint8_t flutuante8bits = flutuanteParaBinario(flutuante);
+    uint8_t flutuante8bits = flutuanteParaBinarioIterativo(flutuante);
     uint16_t pontoFixo = inteiro8bits;
     pontoFixo = (pontoFixo << 8) + flutuante8bits;
     return pontoFixo;
 }
 
-//CONVERTE UM NÚMERO BINÁRIO DE 32 BITS PARA UM NÚMERO REAL.
-float converteParaFloat(uint32_t num){
+//VERSAO ITERATIVA (ORIGINAL) DE converteParaFloat, MANTIDA COMO REFERENCIA.
+float converteParaFloatIterativo(uint32_t num){
     uint16_t inteiro = num >> 16;
     uint16_t flutuante16bits = num;
-    float flutuante = binarioParaFlutuante(flutuante16bits);
+    float flutuante = binarioParaFlutuanteIterativo(flutuante16bits);
     
     float resultado = (float)inteiro + flutuante;
     return resultado;
 }
 
 
-//CONVERTE A PARTE FRACIONÁRIA DE UM NÚMERO PARA UM BINÁRIO DE 8 BITS.
-uint8_t flutuanteParaBinario(float flutuante){
+//VERSAO ITERATIVA (ORIGINAL) DE flutuanteParaBinario, MANTIDA COMO REFERENCIA.
+uint8_t flutuanteParaBinarioIterativo(float flutuante){
     uint8_t resultado = 0;
 
     float valor = flutuante;
@@ -64,8 +114,8 @@ uint8_t flutuanteParaBinario(float flutuante){
     return resultado;
 }
 
-//CONVERTE UM NÚMERO BINÁRIO DE 16 BITS PARA A PARTE FLUTUANTE DE UM NÚMERO REAL.
-float binarioParaFlutuante(uint16_t flutuante){
+//VERSAO ITERATIVA (ORIGINAL) DE binarioParaFlutuante, MANTIDA COMO REFERENCIA.
+float binarioParaFlutuanteIterativo(uint16_t flutuante){
     float buffer = 0.5;
     uint16_t myByte = flutuante;
     float resultado = 0;
@@ -80,30 +130,872 @@ float binarioParaFlutuante(uint16_t flutuante){
     return resultado;
 }
 
-void multiplica_hardware(float **mat1, float **mat2, float **mat3) {
+static int cfsSistolico(void);
+static void consultaCFS(void);
+
+//COM CFS_FLOAT_ATIVADO, OS FLOATS VAO DIRETO PARA O CFS; SENAO (OU NA MATRIZ SISTOLICA), AS COPIAS Q8.8 EM CACHE.
+//RETORNA 0 EM CASO DE SUCESSO OU O ERRO DO DRIVER (POR EXEMPLO, UM CFS COM OPERANDOS MENORES QUE Q8.8); NESTE
+//CASO mat3 NAO E ALTERADA E O PRODUTO DEVE SER FEITO EM SOFTWARE.
+int multiplica_hardware(const MatrizFloat *mat1, const MatrizFloat *mat2, MatrizFloat *mat3) {
   controlPrint("Iniciando multiplicacao das matrizes %u e %u em HARDWARE...\n", mat1, mat2);
-    uint16_t a, b;
-    uint32_t valorReg;
-
-  for(int i = 0; i < MAX_MATRIX; i++) {
-    for (int j = 0; j < MAX_MATRIX; j++) {
-      controlPrint("Multiplicando linha %d de A pela coluna %d de B...\n", i, j);
-      mat3[i][j] = 0;
-      for (int k = 0; k < MAX_MATRIX; k++) {
-        if(k%NUM_REG_CFS == 0 && k!=0){
-          mat3[i][j] = converteParaFloat(NEORV32_CFS->REG[63]);
+  int erro;
+#if CFS_FLOAT_ATIVADO
+  if(!cfsSistolico()) {
+    erro = multiplicaHardwareFloat(mat1, mat2, mat3);
+    if(erro == 0)
+      marcarMatrizAlterada(mat3);
+    return erro;
+  }
+#endif
+  const Matriz16Bits *mat1Q = obterMatrizQuantizada(mat1);
+  const Matriz16Bits *mat2Q = obterMatrizQuantizada(mat2);
+
+  erro = multiplicaHardwarePontoFixo(mat1Q, mat2Q, mat3);
+  if(erro == 0)
+    marcarMatrizAlterada(mat3);
+  return erro;
+}
+
+//NUMERO DE ESCRITAS NO BARRAMENTO DO CFS DESDE O ULTIMO zerarEscritasCFS().
+static uint32_t escritasCFS = 0;
+
+//BITS DE MODO (COMO CFS_IRQ_HABILITADA) MANTIDOS EM TODA ESCRITA NO REGISTRADOR DE CONTROLE. OS OPERANDOS SAO
+//SEMPRE ESCRITOS NA PORTA DE FLUXO (CFS_MODO_FLUXO): CADA VETOR COMECA NA PALAVRA 0 DEPOIS DE UMA ESCRITA NO
+//CONTROLE OU DO FIM DO VETOR ANTERIOR, E AS VIAS A PARTIR DE CFS_CONFIG_VIAS VALEM ZERO.
+static uint32_t modoCFS = CFS_MODO_FLUXO | (CFS_IRQ_ATIVADA ? CFS_IRQ_HABILITADA : 0);
+
+#if CFS_CONTADOR_ATIVADO
+#define escreveCFS(reg, valor) do { NEORV32_CFS->REG[reg] = (valor); escritasCFS++; } while(0)
+#else
+#define escreveCFS(reg, valor) (NEORV32_CFS->REG[reg] = (valor))
+#endif
+
+uint32_t obterEscritasCFS(void) {
+  return escritasCFS;
+}
+
+void zerarEscritasCFS(void) {
+  escritasCFS = 0;
+}
+
+#define escreveControleCFS(valor) escreveCFS(CFS_REG_CONTROLE, (valor) | modoCFS)
+
+//ESCREVE UM COMANDO DOS CONTADORES DE DESEMPENHO. NA MATRIZ SISTOLICA OS BITS 31..16 DO CONTROLE SAO A PROFUNDIDADE
+//DO BLOCO (CFS_SIS_PROFUNDIDADE), ENTAO OS BITS DE modoCFS NAO SAO INCLUIDOS.
+static void comandoContadoresCFS(uint32_t comando) {
+  if(cfsSistolico())
+    escreveCFS(CFS_REG_CONTROLE, comando);
+  else
+    escreveControleCFS(comando);
+}
+
+//REINICIA A CONTAGEM DOS CONTADORES DE DESEMPENHO DO CFS.
+void zerarContadoresCFS(void) {
+  comandoContadoresCFS(CFS_CMD_ZERA_CONTADORES);
+}
+
+//CAPTURA OS CONTADORES DE DESEMPENHO DO CFS (QUE CONTINUAM CONTANDO) E LE A CAPTURA.
+void lerContadoresCFS(ContadoresCFS *contadores) {
+  uint32_t valor[CFS_NUM_CONTADORES];
+  comandoContadoresCFS(CFS_CMD_CAPTURA_CONTADORES);
+  for(int c = 0; c < CFS_NUM_CONTADORES; c++)
+    valor[c] = NEORV32_CFS->REG[CFS_REG_CONTADOR(c)];
+  contadores->ciclos = valor[0];
+  contadores->ocupado = valor[1];
+  contadores->espera = valor[2];
+  contadores->ocioso = valor[3];
+  contadores->escritas = valor[4];
+  contadores->leituras = valor[5];
+  contadores->operacoes = valor[6];
+}
+
+//PORCENTAGEM DE parte EM total.
+static uint32_t porcentagem(uint32_t parte, uint32_t total) {
+  return total ? (uint32_t)(((uint64_t)parte * 100) / total) : 0;
+}
+
+//IMPRIME OS CONTADORES E SE O CFS PASSOU A MAIOR PARTE DO TEMPO CALCULANDO (LIMITADO PELO CALCULO) OU
+//ESPERANDO OPERANDOS DO BARRAMENTO (LIMITADO PELO MMIO).
+void imprimirPerfilCFS(const ContadoresCFS *contadores) {
+  myPrint("PERFIL DO CFS: %u ciclos (ocupado %u, em espera %u, ocioso %u por cento)\n", contadores->ciclos,
+          porcentagem(contadores->ocupado, contadores->ciclos), porcentagem(contadores->espera, contadores->ciclos),
+          porcentagem(contadores->ocioso, contadores->ciclos));
+  myPrint("               %u escritas de operandos, %u leituras de resultados, %u operacoes -> limitado pelo %s\n",
+          contadores->escritas, contadores->leituras, contadores->operacoes,
+          (2 * contadores->ocupado > contadores->ciclos) ? "calculo" : "barramento (MMIO)");
+}
+
+//ESPERA A INTERRUPCAO DO CFS (UMA VEZ POR PRODUTO, VER aguardaFimCFS). ESTA VERSAO SO CONSULTA O ESTADO; NO FREERTOS
+//ELA E SUBSTITUIDA POR UMA QUE BLOQUEIA A TAREFA ATE A ROTINA DE INTERRUPCAO NOTIFICA-LA.
+void __attribute__((weak)) aguardaCFS(void) {
+  while(!(NEORV32_CFS->REG[CFS_REG_STATUS] & CFS_STATUS_IRQ));
+}
+
+//ESCREVE vias VALORES Q8.8, SEPARADOS POR passo ELEMENTOS, NO BANCO SELECIONADO, DUAS VIAS POR PALAVRA.
+static void escreveVetorCFS(const uint16_t *valor, int passo, int vias) {
+  int via;
+  for(via = 0; via + 1 < vias; via += 2, valor += 2 * passo)
+    escreveCFS(CFS_REG_FLUXO, (uint32_t)valor[0] | ((uint32_t)valor[passo] << 16));
+  if(via < vias)
+    escreveCFS(CFS_REG_FLUXO, valor[0]);
+}
+
+#if CFS_DMA_ATIVADO
+//-1: AINDA NAO VERIFICADO, 0: SEM DMA (OU DMA COM ERRO), 1: DMA HABILITADO.
+static int dmaCFS = -1;
+
+//ESCREVE palavras PALAVRAS CONSECUTIVAS DA MEMORIA NO BANCO A (JA SELECIONADO) PELA PORTA DE FLUXO, USANDO
+//O DMA (DUAS VIAS Q8.8, QUATRO INT8 OU UM FLOAT POR PALAVRA, A MESMA ORDEM DA ESCRITA PELA CPU). COM resto, A CPU
+//ESCREVE ultimo NA PALAVRA SEGUINTE (AS VIAS QUE NAO COMPLETAM UMA PALAVRA, JA EMPACOTADAS). RETORNA 0 SE O DMA NAO
+//EXISTE, A ORIGEM NAO ESTA ALINHADA A 32 BITS OU O DMA FALHOU; A PORTA DE FLUXO FICA ENTAO NA PALAVRA 0 DO VETOR.
+static int escreveVetorDMA(const void *origem, int palavras, int resto, uint32_t ultimo) {
+  if(dmaCFS < 0) {
+    dmaCFS = neorv32_dma_available() != 0;
+    if(dmaCFS)
+      neorv32_dma_enable();
+  }
+
+  if(!dmaCFS || palavras == 0 || ((uintptr_t)origem & 3) != 0)
+    return 0;
+
+  //COM A CACHE DE DADOS, O fence ESCREVE NA MEMORIA A ORIGEM QUE O DMA VAI LER. DESTINO CONSTANTE: A PORTA DE FLUXO
+  //(CFS_REG_FLUXO, A PRIMEIRA PALAVRA DO CFS).
+  asm volatile ("fence" ::: "memory");
+  neorv32_dma_transfer((uint32_t)(uintptr_t)origem, NEORV32_CFS_BASE, palavras, DMA_CMD_W2W | DMA_CMD_SRC_INC | DMA_CMD_DST_CONST);
+  //UMA LINHA SAO POUCAS PALAVRAS: CONSULTAR O DMA CUSTA MENOS QUE UMA INTERRUPCAO E DUAS TROCAS DE CONTEXTO. ELE
+  //TERMINA ANTES DA ULTIMA PALAVRA, QUE VEM DEPOIS DAS DELE NA PORTA DE FLUXO.
+  int estado;
+  while((estado = neorv32_dma_status()) == DMA_STATUS_BUSY);
+  if(estado != DMA_STATUS_IDLE) {
+    controlPrint("escreveVetorDMA(): erro %d no DMA, voltando a escrever pela CPU.\n", estado);
+    //O DMA PODE TER ESCRITO PARTE DO VETOR: A ESCRITA NO CONTROLE VOLTA A PORTA DE FLUXO PARA A PALAVRA 0, ENTAO A CPU
+    //REESCREVE O VETOR INTEIRO NAS VIAS CERTAS.
+    escreveControleCFS(CFS_SEL_BANCO_A);
+    dmaCFS = 0;
+    return 0;
+  }
+  if(resto)
+    escreveCFS(CFS_REG_FLUXO, ultimo);
+#if CFS_CONTADOR_ATIVADO
+  escritasCFS += palavras;
+#endif
+  return 1;
+}
+#endif
+
+//CARREGA vias VALORES NO BANCO A, PELO DMA QUANDO POSSIVEL. O BANCO A JA DEVE ESTAR SELECIONADO NO REGISTRADOR
+//DE CONTROLE E CFS_CONFIG_VIAS PROGRAMADO COM vias.
+static void carregaBancoA(const uint16_t *valor, int passo, int vias) {
+#if CFS_DMA_ATIVADO
+  if(passo != 1 || !escreveVetorDMA(valor, vias / 2, vias % 2, (vias % 2) ? valor[vias - 1] : 0))
+#endif
+    escreveVetorCFS(valor, passo, vias);
+}
+
+//ESCREVE vias FLOATS, SEPARADOS POR passo ELEMENTOS, NO BANCO SELECIONADO (MODO CFS_OPERANDOS_FLOAT), UM POR PALAVRA.
+static void escreveVetorFloatCFS(const float *valor, int passo, int vias) {
+  FloatBits f;
+  for(int via = 0; via < vias; via++, valor += passo) {
+    f.valor = *valor;
+    escreveCFS(CFS_REG_FLUXO, f.bits);
+  }
+}
+
+//CARREGA vias FLOATS CONSECUTIVOS NO BANCO A (JA SELECIONADO, MODO CFS_OPERANDOS_FLOAT), COMO carregaBancoA.
+static void carregaBancoAFloat(const float *valor, int vias) {
+#if CFS_DMA_ATIVADO
+  if(!escreveVetorDMA(valor, vias, 0, 0))
+#endif
+    escreveVetorFloatCFS(valor, 1, vias);
+}
+
+//VIAS E COLUNAS DE SAIDA DO PRODUTO ESCALAR, LIDAS DE CFS_REG_INFO POR consultaCFS(). UM CFS QUE NAO AS
+//INFORMA TEM NUM_REG_CFS VIAS E CFS_COLUNAS COLUNAS. bancoSombraCFS E 1 SE O BANCO A E DUPLO E filaCFS E A
+//CAPACIDADE DA FILA DE RESULTADOS (0 SE ELA NAO EXISTE). bitsOperandoCFS E A LARGURA DE CADA OPERANDO DAS VIAS.
+static int viasCFS = NUM_REG_CFS, colunasCFS = CFS_COLUNAS, bancoSombraCFS = 0, filaCFS = 0, bitsOperandoCFS = 16;
+
+//NUMERO DE BLOCOS EM QUE K E DIVIDIDO, COM viasPalavra VIAS POR PALAVRA (2 EM Q8.8, 4 EM INT8). COM MAIS DE UM
+//BLOCO, CADA UM TEM NO MAXIMO O MAIOR MULTIPLO DE viasPalavra ATE viasCFS, PARA QUE TODOS MENOS O ULTIMO
+//OCUPEM PALAVRAS INTEIRAS.
+static int numeroBlocosCFS(int tamK, int viasPalavra) {
+  consultaCFS();
+  int maximo = viasCFS - viasCFS % viasPalavra;
+  if(tamK <= viasCFS)
+    return tamK > 0;
+  return (tamK + maximo - 1) / maximo;
+}
+
+//VIAS DO BLOCO bloco DE K: BLOCOS DE TAMANHOS QUASE IGUAIS E MULTIPLOS DE viasPalavra (SO O ULTIMO PODE NAO SER),
+//ENTAO CADA BLOCO DE UMA LINHA ALINHADA COMECA EM UMA PALAVRA DE 32 BITS, COMO O DMA EXIGE.
+static int viasBlocoCFS(int tamK, int blocos, int bloco, int viasPalavra) {
+  int vias = (tamK / blocos) / viasPalavra * viasPalavra;
+  int resto = tamK - blocos * vias; //MENOR QUE viasPalavra * blocos.
+  return vias + viasPalavra * (bloco < resto / viasPalavra) + ((bloco == blocos - 1) ? resto % viasPalavra : 0);
+}
+
+//EMPACOTA ATE CFS_VIAS_INT8 VALORES INT8 (SEPARADOS POR passo ELEMENTOS) EM UMA PALAVRA, O PRIMEIRO NO BYTE 0.
+static uint32_t empacotaInt8(const int8_t *valor, int passo, int vias) {
+  uint32_t palavra = 0;
+  for(int via = 0; via < vias && via < CFS_VIAS_INT8; via++)
+    palavra |= (uint32_t)(uint8_t)valor[via * passo] << (8 * via);
+  return palavra;
+}
+
+//ESCREVE vias VALORES INT8, SEPARADOS POR passo ELEMENTOS, NO BANCO SELECIONADO (MODO CFS_OPERANDOS_INT8),
+//QUATRO VIAS POR PALAVRA.
+static void escreveVetorInt8CFS(const int8_t *valor, int passo, int vias) {
+  for(int via = 0; via < vias; via += CFS_VIAS_INT8)
+    escreveCFS(CFS_REG_FLUXO, empacotaInt8(valor + via * passo, passo, vias - via));
+}
+
+//CARREGA vias VALORES INT8 CONSECUTIVOS NO BANCO A (JA SELECIONADO, MODO CFS_OPERANDOS_INT8), COMO carregaBancoA.
+static void carregaBancoAInt8(const int8_t *valor, int vias) {
+#if CFS_DMA_ATIVADO
+  int resto = vias % CFS_VIAS_INT8;
+  if(!escreveVetorDMA(valor, vias / CFS_VIAS_INT8, resto != 0, empacotaInt8(valor + vias - resto, 1, resto)))
+#endif
+    escreveVetorInt8CFS(valor, 1, vias);
+}
+
+//DIMENSOES DA MATRIZ SISTOLICA (CFS_REG_INFO). linhasSistolica E 0 QUANDO O CFS E O PRODUTO ESCALAR
+//E -1 ANTES DA PRIMEIRA CONSULTA.
+static int linhasSistolica = -1, colunasSistolica = 0, profundidadeSistolica = 0;
+
+//LE CFS_REG_INFO UMA UNICA VEZ: DIMENSOES DA MATRIZ SISTOLICA OU VIAS E COLUNAS DO PRODUTO ESCALAR.
+static void consultaCFS(void) {
+  if(linhasSistolica >= 0)
+    return;
+  uint32_t info = NEORV32_CFS->REG[CFS_REG_INFO];
+  if(info & CFS_INFO_SISTOLICA) {
+    linhasSistolica = CFS_INFO_LINHAS(info);
+    colunasSistolica = CFS_INFO_COLUNAS(info);
+    profundidadeSistolica = CFS_INFO_PROFUNDIDADE(info);
+    return;
+  }
+  linhasSistolica = 0;
+  if(info & CFS_INFO_PRODUTO) {
+    viasCFS = CFS_INFO_VIAS(info);
+    colunasCFS = CFS_INFO_SAIDAS(info);
+    bitsOperandoCFS = CFS_INFO_BITS_OPERANDO(info);
+    bancoSombraCFS = (info & CFS_INFO_BANCO_SOMBRA) != 0;
+    filaCFS = CFS_FILA_CAPACIDADE(NEORV32_CFS->REG[CFS_REG_ESTADO_FILA]);
+  }
+}
+
+#if CFS_IRQ_ATIVADA
+//1 QUANDO A INTERRUPCAO FOI PROGRAMADA PARA O PRODUTO EM ANDAMENTO.
+static int irqArmadaCFS = 0;
+#endif
+
+//PROGRAMA A INTERRUPCAO DO CFS PARA O FIM DE UM PRODUTO QUE ENFILEIRA resultados SOMAS (O CFS CONTA ATE 0xffff) E
+//ZERA A CONTAGEM. SEM A FILA DE RESULTADOS NADA E ENFILEIRADO E A INTERRUPCAO NAO E USADA.
+static void armaIrqCFS(uint32_t resultados) {
+#if CFS_IRQ_ATIVADA
+  if(filaCFS < colunasCFS || resultados == 0)
+    return;
+  escreveControleCFS(CFS_SEL_CONFIG);
+  escreveCFS(CFS_CONFIG_LIMIAR_IRQ, (resultados > 0xffff) ? 0xffff : resultados);
+  escreveControleCFS(CFS_SEL_BANCO_A | CFS_CMD_RECONHECE_IRQ);
+  irqArmadaCFS = 1;
+#else
+  (void) resultados;
+#endif
+}
+
+//ESPERA A INTERRUPCAO PROGRAMADA POR armaIrqCFS(), UMA UNICA VEZ POR PRODUTO, E A RECONHECE.
+static void aguardaFimCFS(void) {
+#if CFS_IRQ_ATIVADA
+  if(!irqArmadaCFS)
+    return;
+  aguardaCFS();
+  escreveControleCFS(CFS_SEL_BANCO_A | CFS_CMD_RECONHECE_IRQ);
+  irqArmadaCFS = 0;
+#endif
+}
+
+//RETORNA 1 SE AS VIAS DO PRODUTO ESCALAR GUARDAM UM Q8.8 INTEIRO. COM OPERANDOS MENORES QUE 16 BITS, OS DRIVERS
+//Q8.8 E FLOAT TRUNCARIAM OS VALORES, ENTAO RECUSAM O TRABALHO.
+static int cfsOperandosQ88(void) {
+  consultaCFS();
+  return bitsOperandoCFS >= 16;
+}
+
+//RETORNA 1 SE O CFS FOI SINTETIZADO COMO MATRIZ SISTOLICA (IO_CFS_CONFIG BIT 8).
+static int cfsSistolico(void) {
+  consultaCFS();
+  return linhasSistolica != 0;
+}
+
+//TROCA OS BANCOS A ATIVO E SOMBRA NA MESMA ESCRITA DE comando NO REGISTRADOR DE CONTROLE.
+static void trocaBancosCFS(uint32_t comando) {
+  escreveControleCFS(comando | CFS_CMD_TROCA_BANCOS);
+}
+
+//ESCREVE vias VALORES CONSECUTIVOS DE UMA LINHA DE A NO BANCO A (JA SELECIONADO).
+typedef void (*CarregaLinhaCFS)(const void *linha, int vias);
+
+static void carregaLinhaQ88(const void *linha, int vias) {
+  carregaBancoA((const uint16_t *)linha, 1, vias);
+}
+
+static void carregaLinhaFloat(const void *linha, int vias) {
+  carregaBancoAFloat((const float *)linha, vias);
+}
+
+static void carregaLinhaInt8(const void *linha, int vias) {
+  carregaBancoAInt8((const int8_t *)linha, vias);
+}
+
+//PROGRAMA O COMPRIMENTO DOS VETORES (CFS_CONFIG_VIAS) ANTES DE ESCREVER OS BANCOS DE UM BLOCO: A PORTA DE FLUXO
+//VOLTA A PALAVRA 0 DEPOIS DA ULTIMA PALAVRA DE vias VIAS E AS VIAS SEGUINTES DE A VALEM ZERO, ENTAO UM BLOCO MENOR
+//QUE O ANTERIOR NAO PRECISA ZERAR O RESTO DOS BANCOS. DEIXA A CONFIGURACAO SELECIONADA.
+static void defineViasCFS(int vias) {
+  escreveControleCFS(CFS_SEL_CONFIG);
+  escreveCFS(CFS_CONFIG_VIAS, vias);
+}
+
+//SELECIONA O BANCO A E, SE O CFS TEM O BANCO A SOMBRA, PASSA A ESCREVER NELE. RETORNA 1 NESTE CASO.
+static int iniciaLinhasCFS(void) {
+  consultaCFS();
+  if(bancoSombraCFS)
+    modoCFS |= CFS_BANCO_SOMBRA;
+  escreveControleCFS(CFS_SEL_BANCO_A);
+  return bancoSombraCFS;
+}
+
+//VOLTA A ESCREVER NO BANCO A ATIVO.
+static void terminaLinhasCFS(void) {
+  if(modoCFS & CFS_BANCO_SOMBRA) {
+    modoCFS &= ~CFS_BANCO_SOMBRA;
+    escreveControleCFS(CFS_SEL_BANCO_A);
+  }
+}
+
+//GUARDA A SOMA DA LINHA i E COLUNA p: COPIADA COM float32 (BITS DO FLOAT), SENAO SOMADA MODULO 2^32.
+#define guardaSomaCFS(somas, i, p, soma, float32) \
+  do { if(float32) elementoMatriz(somas, i, p) = (soma); else elementoMatriz(somas, i, p) += (soma); } while(0)
+
+//RETIRA DA FILA DE RESULTADOS AS SOMAS DE linhas LINHAS A PARTIR DE primeira, EM LEITURAS SEGUIDAS.
+static void esvaziaFilaCFS(Matriz32Bits *somas, int primeira, int linhas, int colunas, int float32) {
+  for(int i = primeira; i < primeira + linhas; i++)
+    for(int p = 0; p < colunas; p++)
+      guardaSomaCFS(somas, i, p, NEORV32_CFS->REG[CFS_REG_FILA], float32);
+}
+
+//CALCULA AS SOMAS DAS m LINHAS DE A (A PRIMEIRA EM linhaA, AS SEGUINTES A CADA passoLinha BYTES) PELAS colunas
+//COLUNAS DE B JA CARREGADAS (COM defineViasCFS(vias)); carrega ESCREVE vias VALORES DE CADA LINHA NO BANCO A. AS SOMAS DA LINHA i VAO PARA
+//somas(i, 0..colunas-1) (VER guardaSomaCFS; COM float32, LIDAS COMO FLOAT32 DO CFS). E UM PIPELINE DE SOFTWARE:
+//COM O BANCO A SOMBRA, A LINHA i + 1 E ESCRITA NELE ENQUANTO AS SOMAS DA LINHA i SAO CALCULADAS. COM A FILA DE
+//RESULTADOS, CADA LINHA E ENFILEIRADA PELO CFS (NA MESMA ESCRITA QUE TROCA OS BANCOS) E AS SOMAS SO SAO LIDAS
+//QUANDO A FILA ENCHE E NO FINAL, EM RAJADAS, EM VEZ DE UMA LEITURA POR SOMA ENTRE AS ESCRITAS DOS OPERANDOS.
+static void calculaLinhasCFS(const void *linhaA, int passoLinha, int m, int vias, CarregaLinhaCFS carrega,
+                             Matriz32Bits *somas, int colunas, int float32) {
+  const uint8_t *linha = (const uint8_t *)linhaA;
+  if(m <= 0)
+    return;
+
+  consultaCFS();
+  if(filaCFS >= colunas) {
+    int cabem = filaCFS / colunas, naFila = 0;
+    escreveControleCFS(CFS_SEL_CONFIG | CFS_CMD_LIMPA_FILA);
+    escreveCFS(CFS_CONFIG_FILA, colunas | (float32 ? CFS_FILA_FLOAT : 0));
+    int sombra = iniciaLinhasCFS();
+    if(sombra)
+      carrega(linha, vias);
+    //NA ITERACAO i E ENFILEIRADA A LINHA i - 1 (COM O BANCO SOMBRA, ANTES DE A LINHA i SE TORNAR ATIVA) OU i.
+    for(int i = 0; i <= m; i++) {
+      int enfileirada = sombra ? i - 1 : i;
+      if(enfileirada == m)
+        break;
+      if(naFila == cabem) {
+        esvaziaFilaCFS(somas, enfileirada - naFila, naFila, colunas, float32);
+        naFila = 0;
+      }
+      uint32_t comando = CFS_SEL_BANCO_A | ((enfileirada >= 0) ? CFS_CMD_ENFILEIRA : 0);
+      if(!sombra) {
+        carrega(linha + i * passoLinha, vias);
+        escreveControleCFS(comando);
+      } else if(i < m) {
+        trocaBancosCFS(comando);
+        if(i + 1 < m)
+          carrega(linha + (i + 1) * passoLinha, vias);
+      } else {
+        escreveControleCFS(comando);
+      }
+      naFila += enfileirada >= 0;
+    }
+    esvaziaFilaCFS(somas, m - naFila, naFila, colunas, float32);
+    terminaLinhasCFS();
+    return;
+  }
+
+  //SEM A FILA: AS SOMAS DA LINHA i SAO LIDAS DEPOIS DE ESCREVER A LINHA SEGUINTE NO BANCO SOMBRA (SE HOUVER), ENTAO
+  //A LEITURA NAO ESPERA O PIPELINE.
+  int sombra = iniciaLinhasCFS();
+  if(sombra)
+    carrega(linha, vias);
+  for(int i = 0; i < m; i++) {
+    if(!sombra) {
+      carrega(linha + i * passoLinha, vias);
+    } else {
+      trocaBancosCFS(CFS_SEL_BANCO_A);
+      if(i + 1 < m)
+        carrega(linha + (i + 1) * passoLinha, vias);
+    }
+    //A LEITURA DE UMA SOMA SO E CONFIRMADA PELO CFS QUANDO O PIPELINE TERMINA (CFS_STATUS_VALIDO).
+    for(int p = 0; p < colunas; p++)
+      guardaSomaCFS(somas, i, p, NEORV32_CFS->REG[float32 ? CFS_REG_SOMA_FLOAT(p) : CFS_REG_SOMA_COLUNA(p)], float32);
+  }
+  terminaLinhasCFS();
+}
+
+//ESCREVE kk POSICOES DE UM BLOCO NA PORTA reg DA MATRIZ SISTOLICA, vias VALORES POR POSICAO, DOIS POR ESCRITA.
+//A VIA v DA POSICAO k E valor[k * passoK + v * passoVia]; AS VIAS A PARTIR DE validas SAO ESCRITAS COMO ZERO.
+static void escreveBlocoSistolica(int reg, const uint16_t *valor, int passoK, int passoVia, int vias, int validas, int kk) {
+  for(int k = 0; k < kk; k++) {
+    const uint16_t *v = valor + k * passoK;
+    for(int via = 0; via < vias; via += 2) {
+      uint32_t baixo = (via < validas) ? v[via * passoVia] : 0;
+      uint32_t alto = (via + 1 < validas) ? v[(via + 1) * passoVia] : 0;
+      escreveCFS(reg, baixo | (alto << 16));
+    }
+  }
+}
+
+//CALCULA NA MATRIZ SISTOLICA UM BLOCO DE C DE linhas x colunas (NO MAXIMO O TAMANHO DO ARRANJO), COM
+//A(i, k) = a[k * passoKA + i * passoViaA] E B(k, j) = b[k * passoKB + j * passoViaB]. tamK E DIVIDIDO EM BLOCOS
+//DE ATE profundidadeSistolica, SOMADOS NO PROPRIO ARRANJO. COM carregaB = 0 E tamK EM UM UNICO BLOCO, O BLOCO
+//DE B QUE JA ESTA NO CFS E REAPROVEITADO. O RESULTADO (Q16.16) E LIDO DEPOIS EM CFS_SIS_REG_C, LINHA A LINHA.
+static void calculaBlocoSistolica(const uint16_t *a, int passoKA, int passoViaA, int linhas,
+                                  const uint16_t *b, int passoKB, int passoViaB, int colunas, int tamK, int carregaB) {
+  uint32_t comando = CFS_SIS_CMD_INICIA;
+  int k0 = 0;
+  carregaB |= tamK > profundidadeSistolica;
+  do { //tamK = 0 AINDA INICIA UM BLOCO VAZIO, QUE ZERA C.
+    int kk = (tamK - k0 < profundidadeSistolica) ? tamK - k0 : profundidadeSistolica;
+    escreveCFS(CFS_SIS_REG_POSICAO, 0);
+    escreveBlocoSistolica(CFS_SIS_REG_A, a + k0 * passoKA, passoKA, passoViaA, linhasSistolica, linhas, kk);
+    if(carregaB)
+      escreveBlocoSistolica(CFS_SIS_REG_B, b + k0 * passoKB, passoKB, passoViaB, colunasSistolica, colunas, kk);
+    escreveCFS(CFS_REG_CONTROLE, comando | CFS_SIS_PROFUNDIDADE(kk));
+    comando |= CFS_SIS_CMD_ACUMULA;
+    while(!(NEORV32_CFS->REG[CFS_REG_STATUS] & CFS_STATUS_VALIDO));
+    k0 += kk;
+  } while(k0 < tamK);
+}
+
+//CALCULA C = A x B NA MATRIZ SISTOLICA, UM BLOCO DE linhasSistolica x colunasSistolica DE C POR VEZ. PARA CADA
+//GRUPO DE COLUNAS DE B, OS BLOCOS DE A PASSAM EM SEQUENCIA; QUANDO K CABE EM UM BLOCO, O BLOCO DE B E
+//CARREGADO UMA UNICA VEZ POR GRUPO. AS DIMENSOES JA FORAM CONFERIDAS POR multiplicaHardwarePontoFixo.
+static void multiplicaHardwareSistolica(const Matriz16Bits *matA, const Matriz16Bits *matB, MatrizFloat *matC) {
+  int m = matA->linhas, tamK = matA->colunas, n = matB->colunas;
+
+  for(int j0 = 0; j0 < n; j0 += colunasSistolica) {
+    controlPrint("Multiplicando A pelas colunas %d em diante de B...\n", j0);
+    int colunas = (n - j0 < colunasSistolica) ? n - j0 : colunasSistolica;
+    for(int i0 = 0; i0 < m; i0 += linhasSistolica) {
+      int linhas = (m - i0 < linhasSistolica) ? m - i0 : linhasSistolica;
+      calculaBlocoSistolica(&elementoMatriz(matA, i0, 0), 1, matA->passo, linhas,
+                            &elementoMatriz(matB, 0, j0), matB->passo, 1, colunas, tamK, i0 == 0);
+      for(int i = 0; i < linhas; i++) {
+        for(int j = 0; j < colunasSistolica; j++) {
+          uint32_t soma = NEORV32_CFS->REG[CFS_SIS_REG_C];
+          if(j < colunas)
+            elementoMatriz(matC, i0 + i, j0 + j) = converteParaFloat(soma);
         }
+      }
+    }
+  }
+}
 
-        NEORV32_CFS->REG[k%NUM_REG_CFS] = 0;
-        a = converteParaPontoFixo(mat1[i][k]);
-        b = converteParaPontoFixo(mat2[k][j]);
-        valorReg = (a << 16) | b;
-        
-        NEORV32_CFS->REG[k%NUM_REG_CFS] = valorReg; 
-      }  
-      mat3[i][j] += converteParaFloat(NEORV32_CFS->REG[63]);
+//PRODUTO ESCALAR DE DOIS VETORES Q8.8 DE QUALQUER TAMANHO (ELEMENTOS SEPARADOS POR passoA E passoB).
+//CADA BLOCO DE ATE viasCFS VIAS E SOMADO NO ACUMULADOR DO CFS, E O RESULTADO (Q16.16,
+//MODULO 2^32 COMO NA REFERENCIA EM SOFTWARE) E LIDO UMA UNICA VEZ NO FINAL.
+uint32_t produtoEscalarHardware(const uint16_t *a, int passoA, const uint16_t *b, int passoB, int tamanho) {
+  int blocos = numeroBlocosCFS(tamanho, 2);
+  if(blocos == 0)
+    return 0;
+
+  if(cfsSistolico()) { //C(0, 0) DE UM BLOCO COM UMA LINHA DE A E UMA COLUNA DE B.
+    calculaBlocoSistolica(a, passoA, 0, 1, b, passoB, 0, 1, tamanho, 1);
+    return NEORV32_CFS->REG[CFS_SIS_REG_C];
+  }
+
+  uint32_t comando = CFS_SEL_BANCO_A | CFS_CMD_LIMPA_ACUMULADOR | CFS_CMD_ACUMULA;
+  for(int bloco = 0; bloco < blocos; bloco++) {
+    int vias = viasBlocoCFS(tamanho, blocos, bloco, 2);
+    defineViasCFS(vias);
+    escreveControleCFS(CFS_SEL_BANCO_A);
+    carregaBancoA(a, passoA, vias);
+    escreveControleCFS(CFS_SEL_BANCO_B | CFS_COLUNA(0));
+    escreveVetorCFS(b, passoB, vias);
+    escreveControleCFS(comando);
+    comando = CFS_SEL_BANCO_A | CFS_CMD_ACUMULA;
+    a += vias * passoA;
+    b += vias * passoB;
+  }
+  return NEORV32_CFS->REG[CFS_REG_ACUMULADOR_LO(0)];
+}
+
+#if ALOCACAO_ESTATICA
+//MAIOR RASCUNHO: AS SOMAS (MAX_MATRIX x ATE 8 COLUNAS DO CFS) OU OS PARES DE B DA CFU (MAX_MATRIX/2 x MAX_MATRIX).
+#define PALAVRAS_RASCUNHO (MAX_MATRIX * passoMatriz((MAX_MATRIX > 8) ? MAX_MATRIX : 8, sizeof(uint32_t)))
+static uint32_t dadosRascunho[PALAVRAS_RASCUNHO] __attribute__((aligned(MATRIZ_ALINHAMENTO)));
+static Matriz32Bits rascunhoEstatico;
+#endif
+
+//MATRIZ DE RASCUNHO linhas x colunas DOS DRIVERS (UMA POR VEZ). COM ALOCACAO_ESTATICA E SEMPRE O MESMO ARMAZENAMENTO
+//ESTATICO E RETORNA NULL SE NAO COUBER; SENAO VEM DO HEAP. E LIBERADA POR liberaRascunho.
+static Matriz32Bits *criaRascunho(int linhas, int colunas) {
+#if ALOCACAO_ESTATICA
+  if(linhas * passoMatriz(colunas, sizeof(uint32_t)) > PALAVRAS_RASCUNHO) {
+    controlPrint("criaRascunho(): %d x %d nao cabe no rascunho estatico.\n", linhas, colunas);
+    return NULL;
+  }
+  rascunhoEstatico.dados = dadosRascunho;
+  rascunhoEstatico.linhas = linhas;
+  rascunhoEstatico.colunas = colunas;
+  rascunhoEstatico.passo = passoMatriz(colunas, sizeof(uint32_t));
+  rascunhoEstatico.visao = 1;
+  return &rascunhoEstatico;
+#else
+  return criarMatriz32Bits(linhas, colunas);
+#endif
+}
+
+static void liberaRascunho(Matriz32Bits *rascunho) {
+#if ALOCACAO_ESTATICA
+  (void) rascunho;
+#else
+  destruirMatriz32Bits(rascunho);
+#endif
+}
+
+//CALCULA C = A x B NO CFS PARA QUAISQUER M (LINHAS DE A), K (COLUNAS DE A) E N (COLUNAS DE B).
+//AS MATRIZES PODEM SER VISOES (PASSO QUALQUER). K E DIVIDIDO EM BLOCOS QUE CABEM NO CFS, DE TAMANHOS
+//QUASE IGUAIS (VER viasBlocoCFS). AS COLUNAS DE B SAO TRATADAS EM GRUPOS DE colunasCFS:
+//CADA BLOCO DAS COLUNAS DO GRUPO E CARREGADO UMA UNICA VEZ NOS BANCOS B, E CADA LINHA DE A ESCRITA
+//NO BANCO A (DUAS VIAS POR ESCRITA, PELO DMA QUANDO POSSIVEL) PRODUZ colunasCFS SOMAS (VER calculaLinhasCFS). AS SOMAS
+//PARCIAIS (Q16.16) SAO ACUMULADAS MODULO 2^32 ANTES DA UNICA CONVERSAO PARA FLOAT DE CADA ELEMENTO.
+//SE O CFS FOR A MATRIZ SISTOLICA, O PRODUTO E FEITO POR multiplicaHardwareSistolica.
+//RETORNA 0 EM CASO DE SUCESSO E -1 SE AS DIMENSOES FOREM INCOMPATIVEIS, FALTAR MEMORIA OU AS VIAS DO CFS TIVEREM
+//MENOS DE 16 BITS (VER cfsOperandosQ88).
+int multiplicaHardwarePontoFixo(const Matriz16Bits *matA, const Matriz16Bits *matB, MatrizFloat *matC) {
+  if(matA == NULL || matA->dados == NULL || matB == NULL || matB->dados == NULL || matC == NULL || matC->dados == NULL) {
+    controlPrint("multiplicaHardwarePontoFixo(): matriz vazia.\n");
+    return -1;
+  }
+
+  int m = matA->linhas, tamK = matA->colunas, n = matB->colunas;
+  if(matB->linhas != tamK || matC->linhas != m || matC->colunas != n) {
+    controlPrint("multiplicaHardwarePontoFixo(): dimensoes incompativeis.\n");
+    return -1;
+  }
+
+  if(cfsSistolico()) {
+    multiplicaHardwareSistolica(matA, matB, matC);
+    return 0;
+  }
+
+  if(!cfsOperandosQ88()) {
+    controlPrint("multiplicaHardwarePontoFixo(): CFS com operandos de %d bits.\n", bitsOperandoCFS);
+    return -1;
+  }
+
+  Matriz32Bits *somas = criaRascunho(m, colunasCFS);
+  if(somas == NULL)
+    return -1;
+
+  int passoB = matB->passo;
+  int blocos = numeroBlocosCFS(tamK, 2);
+  armaIrqCFS((uint32_t)blocos * m * n);
+
+  for(int j0 = 0; j0 < n; j0 += colunasCFS) {
+    controlPrint("Multiplicando A pelas colunas %d em diante de B...\n", j0);
+    int colunas = (n - j0 < colunasCFS) ? n - j0 : colunasCFS;
+    for(int i = 0; i < m; i++)
+      for(int p = 0; p < colunas; p++)
+        elementoMatriz(somas, i, p) = 0;
+
+    int k0 = 0;
+    for(int bloco = 0; bloco < blocos; bloco++) {
+      int vias = viasBlocoCFS(tamK, blocos, bloco, 2);
+      defineViasCFS(vias);
+
+      for(int p = 0; p < colunas; p++) {
+        escreveControleCFS(CFS_SEL_BANCO_B | CFS_COLUNA(p));
+        escreveVetorCFS(&elementoMatriz(matB, k0, j0 + p), passoB, vias);
+      }
+      calculaLinhasCFS(&elementoMatriz(matA, 0, k0), matA->passo * (int)sizeof(uint16_t), m, vias, carregaLinhaQ88,
+                       somas, colunas, 0);
+      k0 += vias;
+    }
+
+    for(int i = 0; i < m; i++)
+      for(int p = 0; p < colunas; p++)
+        elementoMatriz(matC, i, j0 + p) = converteParaFloat(elementoMatriz(somas, i, p));
+  }
+  aguardaFimCFS();
+
+  liberaRascunho(somas);
+  return 0;
+}
+
+//COMO multiplicaHardwarePontoFixo, MAS COM AS MATRIZES FLOAT: OS BITS IEEE-754 SAO COPIADOS PARA O CFS, QUE OS
+//CONVERTE PARA Q8.8 (COMO converteParaPontoFixo), E QUANDO K CABE EM UM BLOCO A SOMA JA E LIDA COMO FLOAT
+//(COMO converteParaFloat). COM MAIS BLOCOS, AS SOMAS PARCIAIS AINDA SAO ACUMULADAS MODULO 2^32 E CONVERTIDAS
+//UMA UNICA VEZ EM SOFTWARE, PARA O RESULTADO SER IDENTICO AO DA REFERENCIA. CADA VIA OCUPA UMA PALAVRA.
+//RETORNA 0 EM CASO DE SUCESSO E -1 SE AS DIMENSOES FOREM INCOMPATIVEIS, FALTAR MEMORIA OU AS VIAS DO CFS TIVEREM
+//MENOS DE 16 BITS (VER cfsOperandosQ88).
+int multiplicaHardwareFloat(const MatrizFloat *matA, const MatrizFloat *matB, MatrizFloat *matC) {
+  if(matA == NULL || matA->dados == NULL || matB == NULL || matB->dados == NULL || matC == NULL || matC->dados == NULL) {
+    controlPrint("multiplicaHardwareFloat(): matriz vazia.\n");
+    return -1;
+  }
+
+  int m = matA->linhas, tamK = matA->colunas, n = matB->colunas;
+  if(matB->linhas != tamK || matC->linhas != m || matC->colunas != n) {
+    controlPrint("multiplicaHardwareFloat(): dimensoes incompativeis.\n");
+    return -1;
+  }
+
+  if(!cfsOperandosQ88()) {
+    controlPrint("multiplicaHardwareFloat(): CFS com operandos de %d bits.\n", bitsOperandoCFS);
+    return -1;
+  }
+
+  int passoB = matB->passo;
+  int blocos = numeroBlocosCFS(tamK, 2);
+  Matriz32Bits *somas = criaRascunho(m, colunasCFS);
+  if(somas == NULL)
+    return -1;
+
+  armaIrqCFS((uint32_t)blocos * m * n);
+  modoCFS |= CFS_OPERANDOS_FLOAT;
+  for(int j0 = 0; j0 < n; j0 += colunasCFS) {
+    controlPrint("Multiplicando A pelas colunas %d em diante de B...\n", j0);
+    int colunas = (n - j0 < colunasCFS) ? n - j0 : colunasCFS;
+    for(int i = 0; i < m; i++)
+      for(int p = 0; p < colunas; p++)
+        elementoMatriz(somas, i, p) = 0;
+
+    int k0 = 0;
+    for(int bloco = 0; bloco < blocos; bloco++) {
+      int vias = viasBlocoCFS(tamK, blocos, bloco, 2);
+      defineViasCFS(vias);
+
+      for(int p = 0; p < colunas; p++) {
+        escreveControleCFS(CFS_SEL_BANCO_B | CFS_COLUNA(p));
+        escreveVetorFloatCFS(&elementoMatriz(matB, k0, j0 + p), passoB, vias);
+      }
+      //COM UM UNICO BLOCO, AS SOMAS JA VEM DO CFS COMO FLOAT32.
+      calculaLinhasCFS(&elementoMatriz(matA, 0, k0), matA->passo * (int)sizeof(float), m, vias, carregaLinhaFloat,
+                       somas, colunas, blocos == 1);
+      k0 += vias;
     }
+
+    for(int i = 0; i < m; i++)
+      for(int p = 0; p < colunas; p++) {
+        FloatBits f;
+        f.bits = elementoMatriz(somas, i, p);
+        elementoMatriz(matC, i, j0 + p) = (blocos == 1) ? f.valor : converteParaFloat(f.bits);
+      }
+  }
+  modoCFS &= ~CFS_OPERANDOS_FLOAT;
+  aguardaFimCFS();
+
+  liberaRascunho(somas);
+  return 0;
+}
+
+//QUANTIZA origem EM destino (MESMAS DIMENSOES) DE FORMA SIMETRICA: escala = max|x| / 127 E CADA ELEMENTO E
+//x / escala ARREDONDADO PARA O INTEIRO MAIS PROXIMO. RETORNA A ESCALA, TAMBEM GUARDADA EM destino->escala.
+float quantizaMatrizInt8(const MatrizFloat *origem, Matriz8Bits *destino) {
+  if(origem == NULL || origem->dados == NULL || destino == NULL || destino->dados == NULL ||
+     origem->linhas != destino->linhas || origem->colunas != destino->colunas) {
+    controlPrint("quantizaMatrizInt8(): matriz vazia ou dimensoes incompativeis.\n");
+    return 0.0f;
   }
+
+  float maximo = 0.0f;
+  for(int i = 0; i < origem->linhas; i++)
+    for(int j = 0; j < origem->colunas; j++) {
+      float valor = elementoMatriz(origem, i, j);
+      if(valor < 0.0f)
+        valor = -valor;
+      if(valor > maximo)
+        maximo = valor;
+    }
+
+  float escala = (maximo > 0.0f) ? maximo / 127.0f : 1.0f;
+  float inverso = 1.0f / escala;
+  for(int i = 0; i < origem->linhas; i++)
+    for(int j = 0; j < origem->colunas; j++) {
+      float valor = elementoMatriz(origem, i, j) * inverso;
+      int32_t q = (int32_t)(valor + ((valor < 0.0f) ? -0.5f : 0.5f));
+      elementoMatriz(destino, i, j) = (int8_t)((q > 127) ? 127 : ((q < -127) ? -127 : q));
+    }
+  destino->escala = escala;
+  return escala;
+}
+
+//COMO multiplicaHardwarePontoFixo, MAS NO MODO CFS_OPERANDOS_INT8: CADA ESCRITA LEVA QUATRO VIAS (AS LINHAS DE A
+//PELO DMA, QUANDO POSSIVEL) E AS SOMAS SAO INTEIROS COM SINAL. AS SOMAS PARCIAIS DOS BLOCOS DE K SAO ACUMULADAS
+//MODULO 2^32 E MULTIPLICADAS UMA UNICA VEZ POR matA->escala * matB->escala, COMO EM multiplicarMatrizInt8.
+//SO O PRODUTO ESCALAR TEM O MODO INT8. RETORNA 0 EM CASO DE SUCESSO E -1 SE AS DIMENSOES FOREM INCOMPATIVEIS,
+//FALTAR MEMORIA OU O CFS FOR A MATRIZ SISTOLICA.
+int multiplicaHardwareInt8(const Matriz8Bits *matA, const Matriz8Bits *matB, MatrizFloat *matC) {
+  if(matA == NULL || matA->dados == NULL || matB == NULL || matB->dados == NULL || matC == NULL || matC->dados == NULL) {
+    controlPrint("multiplicaHardwareInt8(): matriz vazia.\n");
+    return -1;
+  }
+
+  int m = matA->linhas, tamK = matA->colunas, n = matB->colunas;
+  if(matB->linhas != tamK || matC->linhas != m || matC->colunas != n || cfsSistolico()) {
+    controlPrint("multiplicaHardwareInt8(): dimensoes incompativeis ou CFS sem modo int8.\n");
+    return -1;
+  }
+
+  Matriz32Bits *somas = criaRascunho(m, colunasCFS);
+  if(somas == NULL)
+    return -1;
+
+  float escala = matA->escala * matB->escala;
+  int passoB = matB->passo;
+  int blocos = numeroBlocosCFS(tamK, CFS_VIAS_INT8);
+
+  armaIrqCFS((uint32_t)blocos * m * n);
+  modoCFS |= CFS_OPERANDOS_INT8;
+  for(int j0 = 0; j0 < n; j0 += colunasCFS) {
+    controlPrint("Multiplicando A pelas colunas %d em diante de B...\n", j0);
+    int colunas = (n - j0 < colunasCFS) ? n - j0 : colunasCFS;
+    for(int i = 0; i < m; i++)
+      for(int p = 0; p < colunas; p++)
+        elementoMatriz(somas, i, p) = 0;
+
+    int k0 = 0;
+    for(int bloco = 0; bloco < blocos; bloco++) {
+      int vias = viasBlocoCFS(tamK, blocos, bloco, CFS_VIAS_INT8);
+      defineViasCFS(vias);
+
+      for(int p = 0; p < colunas; p++) {
+        escreveControleCFS(CFS_SEL_BANCO_B | CFS_COLUNA(p));
+        escreveVetorInt8CFS(&elementoMatriz(matB, k0, j0 + p), passoB, vias);
+      }
+      calculaLinhasCFS(&elementoMatriz(matA, 0, k0), matA->passo * (int)sizeof(int8_t), m, vias, carregaLinhaInt8,
+                       somas, colunas, 0);
+      k0 += vias;
+    }
+
+    for(int i = 0; i < m; i++)
+      for(int p = 0; p < colunas; p++)
+        elementoMatriz(matC, i, j0 + p) = escala * (float)(int32_t)elementoMatriz(somas, i, p);
+  }
+  modoCFS &= ~CFS_OPERANDOS_INT8;
+  aguardaFimCFS();
+
+  liberaRascunho(somas);
+  return 0;
+}
+
+//PRODUTO ESCALAR DE DOIS VETORES Q8.8 PELAS INSTRUCOES DA CFU, SEM ACESSOS AO BARRAMENTO DO CFS: CADA cfuMacQ88
+//SOMA DOIS PRODUTOS NO ACUMULADOR 0. O RESULTADO (Q16.16, MODULO 2^32) E O MESMO DE produtoEscalarHardware.
+uint32_t produtoEscalarCFU(const uint16_t *a, int passoA, const uint16_t *b, int passoB, int tamanho) {
+  int k;
+  cfuRetiraAcumulador(0);
+  for(k = 0; k + 1 < tamanho; k += 2) {
+    cfuMacQ88(0, cfuEmpacota(a[0], a[passoA]), cfuEmpacota(b[0], b[passoB]));
+    a += 2 * passoA;
+    b += 2 * passoB;
+  }
+  if(k < tamanho)
+    cfuMacQ88(0, a[0], b[0]);
+  return cfuRetiraAcumulador(0);
+}
+
+//MICRO-KERNEL 1x4 DA CFU: PARA CADA UMA DAS pares POSICOES, CARREGA O PAR Q8.8 DE A (a[k]) E OS PARES DAS QUATRO
+//COLUNAS DE B (b[k * passoB + 0..3]) E SOMA CADA PRODUTO EM UM ACUMULADOR; DEPOIS RETIRA AS QUATRO SOMAS EM c.
+//O LACO E ESCRITO EM ASSEMBLY PARA QUE CADA POSICAO CUSTE SO CINCO CARGAS E QUATRO INSTRUCOES DA CFU.
+static void microKernelCFU(const uint32_t *a, const uint32_t *b, int passoB, int pares, uint32_t *c) {
+  if(pares > 0) {
+    asm volatile (
+      "1:\n"
+      "  lw   t0, 0(%[a])\n"
+      "  lw   t1, 0(%[b])\n"
+      "  lw   t2, 4(%[b])\n"
+      "  lw   t3, 8(%[b])\n"
+      "  lw   t4, 12(%[b])\n"
+      "  .insn r 0x0b, 0, 0, zero, t0, t1\n"
+      "  .insn r 0x0b, 0, 1, zero, t0, t2\n"
+      "  .insn r 0x0b, 0, 2, zero, t0, t3\n"
+      "  .insn r 0x0b, 0, 3, zero, t0, t4\n"
+      "  addi %[a], %[a], 4\n"
+      "  add  %[b], %[b], %[passo]\n"
+      "  addi %[n], %[n], -1\n"
+      "  bnez %[n], 1b\n"
+      : [a] "+r" (a), [b] "+r" (b), [n] "+r" (pares)
+      : [passo] "r" (passoB * (int)sizeof(uint32_t))
+      : "t0", "t1", "t2", "t3", "t4", "memory");
+  }
+  c[0] = cfuRetiraAcumulador(0);
+  c[1] = cfuRetiraAcumulador(1);
+  c[2] = cfuRetiraAcumulador(2);
+  c[3] = cfuRetiraAcumulador(3);
+}
+
+//CALCULA C = A x B COM AS INSTRUCOES DA CFU, PARA COMPARAR A ACELERACAO NO PIPELINE COM A DO CFS. AS LINHAS DE A SAO
+//LIDAS COMO PARES Q8.8 DE 32 BITS (A DEVE COMECAR EM UMA PALAVRA E TER PASSO PAR, COMO AS MATRIZES CRIADAS POR
+//criarMatriz16Bits); B E EMPACOTADA UMA UNICA VEZ EM PARES DE LINHAS, COM AS COLUNAS COMPLETADAS COM ZEROS ATE UM
+//MULTIPLO DE 4 E, PARA K IMPAR, UMA LINHA EXTRA DE ZEROS (QUE ANULA O ELEMENTO DE PREENCHIMENTO DE A). O RESULTADO E
+//IDENTICO AO DE multiplicarMatrizPontoFixo. RETORNA 0 EM CASO DE SUCESSO E -1 SE AS DIMENSOES FOREM INCOMPATIVEIS,
+//A NAO ESTIVER ALINHADA, FALTAR MEMORIA OU NAO HOUVER CFU.
+int multiplicaCFU(const Matriz16Bits *matA, const Matriz16Bits *matB, MatrizFloat *matC) {
+  if(matA == NULL || matA->dados == NULL || matB == NULL || matB->dados == NULL || matC == NULL || matC->dados == NULL) {
+    controlPrint("multiplicaCFU(): matriz vazia.\n");
+    return -1;
+  }
+
+  int m = matA->linhas, tamK = matA->colunas, n = matB->colunas;
+  if(matB->linhas != tamK || matC->linhas != m || matC->colunas != n ||
+     ((uintptr_t)matA->dados & 3) != 0 || (matA->passo & 1) != 0) {
+    controlPrint("multiplicaCFU(): dimensoes incompativeis ou matriz A desalinhada.\n");
+    return -1;
+  }
+
+  if(neorv32_cfu_available() == 0) {
+    controlPrint("multiplicaCFU(): CPU sem CFU (CPU_EXTENSION_RISCV_Zxcfu).\n");
+    return -1;
+  }
+
+  int pares = (tamK + 1) / 2;
+  Matriz32Bits *paresB = criaRascunho(pares, (n + 3) & ~3);
+  if(paresB == NULL)
+    return -1;
+
+  for(int k2 = 0; k2 < pares; k2++) {
+    for(int j = 0; j < paresB->colunas; j++) {
+      uint32_t baixo = (j < n) ? elementoMatriz(matB, 2 * k2, j) : 0;
+      uint32_t alto = (j < n && 2 * k2 + 1 < tamK) ? elementoMatriz(matB, 2 * k2 + 1, j) : 0;
+      elementoMatriz(paresB, k2, j) = cfuEmpacota(baixo, alto);
+    }
+  }
+
+  uint32_t soma[CFU_ACUMULADORES];
+  cfuRetiraAcumulador(0); //O NUMERO DO ACUMULADOR FAZ PARTE DA INSTRUCAO.
+  cfuRetiraAcumulador(1);
+  cfuRetiraAcumulador(2);
+  cfuRetiraAcumulador(3);
+  for(int i = 0; i < m; i++) {
+    const uint32_t *linhaA = (const uint32_t *)&elementoMatriz(matA, i, 0);
+    for(int j0 = 0; j0 < n; j0 += CFU_ACUMULADORES) {
+      microKernelCFU(linhaA, &elementoMatriz(paresB, 0, j0), paresB->passo, pares, soma);
+      for(int p = 0; p < CFU_ACUMULADORES && j0 + p < n; p++)
+        elementoMatriz(matC, i, j0 + p) = converteParaFloat(soma[p]);
+    }
+  }
+
+  liberaRascunho(paresB);
+  return 0;
 }
 
 void print(const char * string, float valor){